@@ -646,6 +646,15 @@ rjson::v2::value rjson::v2::parse_string(std::string_view data, remove_comments
 
 // ----------------------------------------------------------------------
 
+rjson::v2::value rjson::v2::parse_string(std::string_view data, arena_t& arena, remove_comments rc)
+{
+    const arena_t::scope in_arena{arena};
+    return parse_string(data, rc);
+
+} // rjson::v2::parse_string
+
+// ----------------------------------------------------------------------
+
 // rjson::v2::value rjson::v2::parse_string(const char* data, remove_comments rc)
 // {
 //     return rjson::v2::parser_pop::parse_string(data, rc);
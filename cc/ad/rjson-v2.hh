@@ -16,6 +16,7 @@
 #include <string_view>
 #include <vector>
 #include <map>
+#include <memory_resource>
 #include <algorithm>
 #include <stdexcept>
 #include <type_traits>
@@ -81,6 +82,48 @@ namespace rjson::inline v2
 
     // --------------------------------------------------
 
+    // Objects and arrays created on a thread while arena_t::scope is alive
+    // allocate their nodes and buffers in the arena, parsing a large
+    // document then avoids millions of small heap allocations and
+    // destroying it releases them in bulk. The arena must outlive values
+    // created in it (copies are allocated on the heap, moved values keep
+    // the arena). Arena is not thread safe, values in it must not be
+    // modified concurrently.
+    class arena_t
+    {
+      public:
+        explicit arena_t(size_t initial_size = 1024 * 1024) : resource_{initial_size} {}
+        arena_t(const arena_t&) = delete;
+        arena_t& operator=(const arena_t&) = delete;
+
+        class scope
+        {
+          public:
+            scope(arena_t& arena);
+            scope(const scope&) = delete;
+            scope& operator=(const scope&) = delete;
+            ~scope();
+
+          private:
+            std::pmr::memory_resource* previous_;
+        };
+
+      private:
+        std::pmr::monotonic_buffer_resource resource_;
+    };
+
+    namespace detail
+    {
+        inline thread_local std::pmr::memory_resource* arena_resource{nullptr};
+
+        inline std::pmr::memory_resource* memory_resource() noexcept { return arena_resource ? arena_resource : std::pmr::get_default_resource(); }
+    } // namespace detail
+
+    inline arena_t::scope::scope(arena_t& arena) : previous_{detail::arena_resource} { detail::arena_resource = &arena.resource_; }
+    inline arena_t::scope::~scope() { detail::arena_resource = previous_; }
+
+    // --------------------------------------------------
+
     class null
     {
     };
@@ -94,11 +137,11 @@ namespace rjson::inline v2
     class object
     {
       public:
-        using content_t = std::map<std::string, value>;
+        using content_t = std::pmr::map<std::string, value>;
         using value_type = typename content_t::value_type;
         using value_type_init = std::pair<std::string_view, value>;
 
-        object() = default;
+        object();
         object(std::initializer_list<value_type_init> key_values);
 
         bool empty() const noexcept { return content_.empty(); }
@@ -124,7 +167,7 @@ namespace rjson::inline v2
         template <typename F> void for_each(F&& func);
 
       private:
-        content_t content_{};
+        content_t content_;
 
         friend std::string format(const object& val, space_after_comma, const PrettyHandler&, show_empty_values);
         friend std::string pretty(const object& val, emacs_indent, const PrettyHandler&, size_t prefix);
@@ -139,9 +182,9 @@ namespace rjson::inline v2
     class array
     {
       public:
-        array() = default;
+        array();
         array(std::initializer_list<value> init);
-        template <typename Iterator> array(Iterator first, Iterator last) : content_(first, last) {}
+        template <typename Iterator> array(Iterator first, Iterator last) : content_(first, last, detail::memory_resource()) {}
 
         bool empty() const noexcept { return content_.empty(); }
         size_t size() const noexcept;
@@ -169,7 +212,7 @@ namespace rjson::inline v2
         template <typename Func> std::optional<size_t> find_index_if(Func&& func) const;
 
       private:
-        std::vector<value> content_{};
+        std::pmr::vector<value> content_;
 
         friend std::string format(const array& val, space_after_comma, const PrettyHandler&, show_empty_values);
         friend std::string pretty(const array& val, emacs_indent, const PrettyHandler&, size_t prefix);
@@ -514,7 +557,8 @@ template <typename T> struct fmt::formatter<T, std::enable_if_t<std::is_same_v<r
 
 namespace rjson::inline v2
 {
-    inline array::array(std::initializer_list<value> init) : content_(init) {}
+    inline array::array() : content_(detail::memory_resource()) {}
+    inline array::array(std::initializer_list<value> init) : content_(init, detail::memory_resource()) {}
     inline size_t array::size() const noexcept { return content_.size(); }
     inline size_t array::max_index() const { return content_.size() - 1; }
 
@@ -762,7 +806,8 @@ namespace rjson::inline v2
 
     // --------------------------------------------------
 
-    inline object::object(std::initializer_list<value_type_init> key_values) : content_(std::begin(key_values), std::end(key_values)) {}
+    inline object::object() : content_(detail::memory_resource()) {}
+    inline object::object(std::initializer_list<value_type_init> key_values) : content_(std::begin(key_values), std::end(key_values), detail::memory_resource()) {}
 
     template <typename S> inline const value& object::get(S key) const noexcept
     {
@@ -853,6 +898,7 @@ namespace rjson::inline v2
 
     // value parse_string(std::string data, remove_comments rc = remove_comments::yes);
     value parse_string(std::string_view data, remove_comments rc = remove_comments::yes);
+    value parse_string(std::string_view data, arena_t& arena, remove_comments rc = remove_comments::yes); // objects and arrays of the result are in the arena
     // value parse_string(const char* data, remove_comments rc = remove_comments::yes);
     value parse_file(std::string_view filename, remove_comments rc = remove_comments::yes);
 
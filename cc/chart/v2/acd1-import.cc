@@ -36,7 +36,9 @@ ChartP ae::chart::v2::acd1_import(std::string_view aData, Verify aVerify)
 {
     const std::string json = convert_to_json(aData);
     try {
-        auto chart = std::make_shared<Acd1Chart>(rjson::parse_string(json));
+        auto arena = std::make_unique<rjson::arena_t>(json.size());
+        auto data = rjson::parse_string(json, *arena);
+        auto chart = std::make_shared<Acd1Chart>(std::move(arena), std::move(data));
         chart->verify_data(aVerify);
         return chart;
     }
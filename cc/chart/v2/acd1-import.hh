@@ -17,6 +17,7 @@ namespace ae::chart::v2
     {
       public:
         Acd1Chart(rjson::value&& aSrc) : data_{std::move(aSrc)} {}
+        Acd1Chart(std::unique_ptr<rjson::arena_t> arena, rjson::value&& aSrc) : arena_{std::move(arena)}, data_{std::move(aSrc)} {} // aSrc was parsed into arena
 
         InfoP info() const override;
         AntigensP antigens() const override;
@@ -31,6 +32,7 @@ namespace ae::chart::v2
         void verify_data(Verify aVerify) const;
 
      private:
+        std::unique_ptr<rjson::arena_t> arena_{}; // destroyed after data_
         rjson::value data_{};
         mutable acd1::name_index_t mAntigenNameIndex{};
         mutable ProjectionsP projections_{};
@@ -5,6 +5,7 @@
 #include "utils/log.hh"
 #include "virus/name.hh"
 #include "utils/string.hh"
+#include "ext/simdjson.hh"
 #include "chart/v2/ace-import.hh"
 #include "chart/v2/ace.hh"
 
@@ -34,9 +35,81 @@ bool ae::chart::v2::is_ace(std::string_view aData)
 
 // ----------------------------------------------------------------------
 
+namespace ae::chart::v2::ace
+{
+    // .ace written by ae/acmacs is strict json and is parsed by simdjson
+    // into rjson DOM, keys dropped by rjson::parse_string() (comments:
+    // "?key", "key?"; emacs indent: toplevel "_") are skipped
+    inline bool is_comment_key(std::string_view key) { return !key.empty() && (key.front() == '?' || key.back() == '?'); }
+
+    // token text without trailing whitespace
+    inline std::string_view raw_token(::simdjson::ondemand::value& source) { return ae::string::strip(static_cast<std::string_view>(source.raw_json_token())); }
+
+    static rjson::value from_simdjson(::simdjson::ondemand::value source);
+
+    static rjson::object from_simdjson(::simdjson::ondemand::object source, bool toplevel)
+    {
+        rjson::object result;
+        for (auto field : source) {
+            const std::string_view key = field.unescaped_key();
+            if (!is_comment_key(key) && (!toplevel || key != "_"))
+                result.insert(rjson::value{std::string{key}}, from_simdjson(field.value()));
+        }
+        return result;
+    }
+
+    rjson::value from_simdjson(::simdjson::ondemand::value source)
+    {
+        using namespace ::simdjson::ondemand;
+        switch (source.type()) {
+            case json_type::object:
+                return from_simdjson(source.get_object(), false);
+            case json_type::array: {
+                rjson::array result;
+                for (auto element : source.get_array())
+                    result.append(from_simdjson(element.value()));
+                return result;
+            }
+            case json_type::string: { // rjson keeps strings escaped
+                const auto token = raw_token(source);
+                return std::string{token.substr(1, token.size() - 2)};
+            }
+            case json_type::number:
+                if (const number_type type = source.get_number_type(); type == number_type::signed_integer)
+                    return rjson::number{static_cast<long>(source.get_int64())};
+                else if (type == number_type::floating_point_number)
+                    return rjson::number{static_cast<double>(source.get_double())};
+                else // does not fit into long, keep text as rjson::parse_string() does
+                    return rjson::number{std::string{raw_token(source)}};
+            case json_type::boolean:
+                return static_cast<bool>(source.get_bool());
+            case json_type::null:
+                break;
+        }
+        return rjson::null{};
+    }
+
+} // namespace ae::chart::v2::ace
+
+// ----------------------------------------------------------------------
+
 ChartP ae::chart::v2::ace_import(std::string_view aData, Verify aVerify)
 {
-    auto chart = std::make_shared<AceChart>(rjson::parse_string(aData));
+    auto arena = std::make_unique<rjson::arena_t>(aData.size());
+    const auto parse = [aData, &arena]() -> rjson::value {
+        const rjson::arena_t::scope in_arena{*arena};
+        try {
+            ae::simdjson::Parser parser{aData};
+            return ace::from_simdjson(parser.doc().get_object(), true);
+        }
+        catch (::simdjson::simdjson_error&) {
+            // json extensions (e.g. # comments) are accepted by the rjson parser only
+            return rjson::parse_string(aData);
+        }
+    };
+
+    auto data = parse();
+    auto chart = std::make_shared<AceChart>(std::move(arena), std::move(data));
     chart->verify_data(aVerify);
     return chart;
 
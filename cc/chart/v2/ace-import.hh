@@ -17,6 +17,7 @@ namespace ae::chart::v2
     {
       public:
         AceChart(rjson::value&& aSrc) : data_{std::move(aSrc)} {}
+        AceChart(std::unique_ptr<rjson::arena_t> arena, rjson::value&& aSrc) : arena_{std::move(arena)}, data_{std::move(aSrc)} {} // aSrc was parsed into arena
 
         InfoP info() const override;
         AntigensP antigens() const override;
@@ -35,6 +36,7 @@ namespace ae::chart::v2
         const rjson::value& extension_fields() const override;
 
      private:
+        std::unique_ptr<rjson::arena_t> arena_{}; // destroyed after data_
         rjson::value data_{};
         mutable ace::name_index_t mAntigenNameIndex{};
         mutable ProjectionsP projections_{};
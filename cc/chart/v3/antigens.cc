@@ -46,6 +46,7 @@ bool ae::chart::v3::Annotations::match(const Annotations& antigen, const Annotat
 
 void ae::chart::v3::AntigenSerum::update_with(const AntigenSerum& src)
 {
+    container_.bump();
     if (lineage_.empty())
         lineage_ = src.lineage();
     else if (!src.lineage().empty() && lineage_ != src.lineage())
@@ -4,6 +4,7 @@
 #include <unordered_map>
 
 #include "ext/compare.hh"
+#include "ext/hash.hh"
 #include "utils/string.hh"
 #include "virus/name.hh"
 #include "virus/passage.hh"
@@ -41,6 +42,61 @@ namespace ae::chart::v3
 
     // ----------------------------------------------------------------------
 
+    // Designation strings and their hashes (xxhash64) computed on first
+    // use, reset by AntigenSerum/Antigen/Serum setters of the fields they
+    // are made of. Derived data: not compared.
+    struct designation_cache_t
+    {
+        struct entry_t
+        {
+            std::string text;
+            uint64_t hash;
+        };
+
+        bool operator==(const designation_cache_t&) const { return true; }
+        void reset()
+        {
+            designation.reset();
+            basic_designation.reset();
+        }
+
+        std::optional<entry_t> designation{};
+        std::optional<entry_t> basic_designation{};
+    };
+
+    // Modification counter of the AntigensSera container an antigen/serum
+    // is stored in, bumped by AntigenSerum/Antigen/Serum setters, see
+    // AntigensSera::modifications(). Copy constructed antigen/serum is not
+    // attached to any container, assignment keeps the container of the
+    // target. Not compared.
+    struct container_counter_t
+    {
+        container_counter_t() = default;
+        container_counter_t(const container_counter_t&) {}
+        container_counter_t(container_counter_t&& src) noexcept : counter{src.counter} {} // reallocation of the container
+        container_counter_t& operator=(const container_counter_t&)
+        {
+            bump();
+            return *this;
+        }
+        container_counter_t& operator=(container_counter_t&&) noexcept
+        {
+            bump();
+            return *this;
+        }
+        bool operator==(const container_counter_t&) const { return true; }
+
+        void bump()
+        {
+            if (counter)
+                ++*counter;
+        }
+
+        size_t* counter{nullptr};
+    };
+
+    // ----------------------------------------------------------------------
+
     class AntigenSerum
     {
       public:
@@ -52,28 +108,98 @@ namespace ae::chart::v3
         bool operator==(const AntigenSerum&) const = default;
 
         const auto& name() const { return name_; }
-        void name(const virus::Name& name) { name_ = name; }
+        void name(const virus::Name& name)
+        {
+            name_ = name;
+            designation_modified();
+        }
         const auto& annotations() const { return annotations_; }
-        Annotations& annotations() { return annotations_; }
+        Annotations& annotations()
+        {
+            designation_modified();
+            return annotations_;
+        }
         const auto& lineage() const { return lineage_; }
-        void lineage(const sequences::lineage_t& lineage) { lineage_ = lineage; }
+        void lineage(const sequences::lineage_t& lineage)
+        {
+            lineage_ = lineage;
+            container_.bump();
+        }
         const auto& passage() const { return passage_; }
-        void passage(const virus::Passage& passage) { passage_ = passage; }
+        void passage(const virus::Passage& passage)
+        {
+            passage_ = passage;
+            designation_modified();
+        }
         const auto& reassortant() const { return reassortant_; }
-        void reassortant(const virus::Reassortant& reassortant) { reassortant_ = reassortant; }
+        void reassortant(const virus::Reassortant& reassortant)
+        {
+            reassortant_ = reassortant;
+            designation_modified();
+        }
         const auto& aa() const { return aa_; }
-        void aa(const sequences::sequence_aa_t& aa) { aa_ = aa; }
+        void aa(const sequences::sequence_aa_t& aa)
+        {
+            aa_ = aa;
+            container_.bump();
+        }
         const auto& nuc() const { return nuc_; }
-        void nuc(const sequences::sequence_nuc_t& nuc) { nuc_ = nuc; }
+        void nuc(const sequences::sequence_nuc_t& nuc)
+        {
+            nuc_ = nuc;
+            container_.bump();
+        }
         const auto& aa_insertions() const { return aa_insertions_; }
-        void aa_insertions(const sequences::insertions_t& aa_insertions) { aa_insertions_ = aa_insertions; }
+        void aa_insertions(const sequences::insertions_t& aa_insertions)
+        {
+            aa_insertions_ = aa_insertions;
+            container_.bump();
+        }
         const auto& nuc_insertions() const { return nuc_insertions_; }
-        void nuc_insertions(const sequences::insertions_t& nuc_insertions) { nuc_insertions_ = nuc_insertions; }
+        void nuc_insertions(const sequences::insertions_t& nuc_insertions)
+        {
+            nuc_insertions_ = nuc_insertions;
+            container_.bump();
+        }
         const auto& semantic() const { return semantic_; }
-        SemanticAttributes& semantic() { return semantic_; }
+        SemanticAttributes& semantic()
+        {
+            container_.bump();
+            return semantic_;
+        }
 
         void update_with(const AntigenSerum& src);
 
+        // name, annotations, reassortant, see compare_basic_designations()
+        const std::string& basic_designation() const { return cached_basic_designation().text; }
+        uint64_t basic_designation_hash() const { return cached_basic_designation().hash; }
+
+      protected:
+        // designation cache is not thread safe: first call of (basic_)designation() or its hash for an antigen/serum must not be concurrent
+        mutable designation_cache_t designation_cache_{};
+        container_counter_t container_{};
+
+        void designation_modified()
+        {
+            designation_cache_.reset();
+            container_.bump();
+        }
+
+        template <typename Make> static const designation_cache_t::entry_t& cached(std::optional<designation_cache_t::entry_t>& cache, Make&& make)
+        {
+            if (!cache) {
+                auto text = make();
+                const auto hash = xxhash::xxhash64(text);
+                cache.emplace(designation_cache_t::entry_t{std::move(text), hash});
+            }
+            return *cache;
+        }
+
+        const designation_cache_t::entry_t& cached_basic_designation() const
+        {
+            return cached(designation_cache_.basic_designation, [this]() { return string::join(" ", name(), string::join(" ", annotations()), reassortant()); });
+        }
+
       private:
         virus::Name name_{};
         Annotations annotations_{};
@@ -85,6 +211,8 @@ namespace ae::chart::v3
         sequences::insertions_t aa_insertions_{};
         sequences::insertions_t nuc_insertions_{};
         SemanticAttributes semantic_{};
+
+        template <typename Element> friend class AntigensSera;
     };
 
     inline auto compare_basic_designations(const AntigenSerum& a1, const AntigenSerum& a2)
@@ -104,11 +232,20 @@ namespace ae::chart::v3
         bool operator==(const Antigen&) const = default;
 
         const auto& date() const { return date_; }
-        void date(const Date& date) { date_ = date; }
+        void date(const Date& date)
+        {
+            date_ = date;
+            container_.bump();
+        }
         const auto& lab_ids() const { return lab_ids_; }
-        LabIds& lab_ids() { return lab_ids_; }
+        LabIds& lab_ids()
+        {
+            container_.bump();
+            return lab_ids_;
+        }
 
-        std::string designation() const { return string::join(" ", name(), string::join(" ", annotations()), reassortant(), passage()); }
+        const std::string& designation() const { return cached_designation().text; }
+        uint64_t designation_hash() const { return cached_designation().hash; }
         size_t designation_size() const { return string::join_size(1, name().size(), annotations().join_size(1), reassortant().size(), passage().size()); }
 
         static inline const char* ag_sr = "AG";
@@ -116,6 +253,11 @@ namespace ae::chart::v3
         void update_with(const Antigen& src);
 
       private:
+        const designation_cache_t::entry_t& cached_designation() const
+        {
+            return cached(designation_cache_.designation, [this]() { return string::join(" ", name(), string::join(" ", annotations()), reassortant(), passage()); });
+        }
+
         Date date_{};
         LabIds lab_ids_{};
     };
@@ -132,17 +274,34 @@ namespace ae::chart::v3
         bool operator==(const Serum&) const = default;
 
         const auto& serum_species() const { return serum_species_; }
-        void serum_species(const SerumSpecies& serum_species) { serum_species_ = serum_species; }
+        void serum_species(const SerumSpecies& serum_species)
+        {
+            serum_species_ = serum_species;
+            container_.bump();
+        }
         const auto& serum_id() const { return serum_id_; }
-        void serum_id(const SerumId& serum_id) { serum_id_ = serum_id; }
+        void serum_id(const SerumId& serum_id)
+        {
+            serum_id_ = serum_id;
+            designation_modified();
+        }
         // const auto& homologous_antigens() const { return homologous_antigens_; }
         // antigen_indexes& homologous_antigens() { return homologous_antigens_; }
 
         std::optional<double> forced_column_basis() const { return forced_column_basis_; }
-        void forced_column_basis(double forced) { forced_column_basis_ = forced; }
-        void not_forced_column_basis() { forced_column_basis_ = std::nullopt; }
+        void forced_column_basis(double forced)
+        {
+            forced_column_basis_ = forced;
+            container_.bump();
+        }
+        void not_forced_column_basis()
+        {
+            forced_column_basis_ = std::nullopt;
+            container_.bump();
+        }
 
-        std::string designation() const { return string::join(" ", name(), string::join(" ", annotations()), reassortant(), serum_id()); }
+        const std::string& designation() const { return cached_designation().text; }
+        uint64_t designation_hash() const { return cached_designation().hash; }
         size_t designation_size() const { return string::join_size(1, name().size(), annotations().join_size(1), reassortant().size(), serum_id().size()); }
 
         static inline const char* ag_sr = "SR";
@@ -150,6 +309,11 @@ namespace ae::chart::v3
         void update_with(const Serum& src);
 
       private:
+        const designation_cache_t::entry_t& cached_designation() const
+        {
+            return cached(designation_cache_.designation, [this]() { return string::join(" ", name(), string::join(" ", annotations()), reassortant(), serum_id()); });
+        }
+
         SerumSpecies serum_species_{};
         SerumId serum_id_{};
         // antigen_indexes homologous_antigens_{};
@@ -166,23 +330,59 @@ namespace ae::chart::v3
         using indexes_t = typename Element::indexes_t;
 
         AntigensSera() = default;
-        AntigensSera(const AntigensSera&) = default;
-        AntigensSera(AntigensSera&&) = default;
-        AntigensSera& operator=(const AntigensSera&) = default;
-        AntigensSera& operator=(AntigensSera&&) = default;
-        bool operator==(const AntigensSera&) const = default;
+        // modifications count is copied and never goes back, derived data
+        // copied along with the container (e.g. Chart::attributes()
+        // cache) stays valid for it but not for different contents that
+        // happen to reach the same count
+        AntigensSera(const AntigensSera& src) : data_{src.data_}, modifications_{src.modifications_} { attach(); }
+        AntigensSera(AntigensSera&& src) noexcept : data_{std::move(src.data_)}, modifications_{src.modifications_} { attach(); }
+        AntigensSera& operator=(const AntigensSera& src)
+        {
+            data_ = src.data_;
+            attach();
+            modifications_ = std::max(modifications_, src.modifications_) + 1;
+            return *this;
+        }
+        AntigensSera& operator=(AntigensSera&& src) noexcept
+        {
+            data_ = std::move(src.data_);
+            attach();
+            modifications_ = std::max(modifications_, src.modifications_) + 1;
+            return *this;
+        }
+        bool operator==(const AntigensSera& rhs) const { return data_ == rhs.data_; }
+
+        // incremented on each modification of antigens/sera, incl.
+        // modifications via references to the elements, used to
+        // invalidate derived data (see Chart::attributes())
+        size_t modifications() const { return modifications_; }
 
         index_t size() const { return index_t{data_.size()}; }
         Element& operator[](index_t index) { return data_[*index]; }
         const Element& operator[](index_t index) const { return data_[*index]; }
-        void resize(index_t sz) { data_.resize(*sz); }
+        void resize(index_t sz)
+        {
+            data_.resize(*sz);
+            attach();
+            ++modifications_;
+        }
 
         auto begin() const { return data_.begin(); }
         auto begin() { return data_.begin(); }
         auto end() const { return data_.end(); }
         auto end() { return data_.end(); }
 
-        Element& add() { return data_.emplace_back(); }
+        Element& add()
+        {
+            const auto capacity = data_.capacity();
+            auto& element = data_.emplace_back();
+            if (data_.capacity() != capacity)
+                attach(); // elements might be copied on reallocation
+            else
+                element.container_.counter = &modifications_;
+            ++modifications_;
+            return element;
+        }
 
         size_t max_designation() const
         {
@@ -196,19 +396,25 @@ namespace ae::chart::v3
         duplicates_t find_duplicates() const
         {
             using map_value_t = std::vector<index_t>;
-            std::unordered_map<std::string, map_value_t> designations_to_indexes;
+            std::unordered_map<uint64_t, map_value_t> designations_to_indexes;
             for (const auto index : size()) {
                 const auto& ag{operator[](index)};
                 if (!ag.annotations().distinct()) {
-                    auto [pos, inserted] = designations_to_indexes.try_emplace(ag.designation(), map_value_t{});
+                    auto [pos, inserted] = designations_to_indexes.try_emplace(ag.designation_hash(), map_value_t{});
                     pos->second.push_back(index);
                 }
             }
 
             duplicates_t result;
-            for (auto [designation, indexes] : designations_to_indexes) {
-                if (indexes.size() > 1)
-                    result.push_back(std::move(indexes));
+            for (auto& [hash, indexes] : designations_to_indexes) {
+                // the same hash for different designations is unlikely but possible, split by designation
+                while (indexes.size() > 1) {
+                    const auto designation = operator[](indexes.front()).designation();
+                    const auto different = std::stable_partition(indexes.begin(), indexes.end(), [this, &designation](index_t index) { return operator[](index).designation() == designation; });
+                    if (different - indexes.begin() > 1)
+                        result.push_back(map_value_t(indexes.begin(), different));
+                    indexes.erase(indexes.begin(), different);
+                }
             }
             return result;
         }
@@ -225,12 +431,20 @@ namespace ae::chart::v3
         {
             for (const auto ind : to_vector_base_t_descending(indexes))
                 data_.erase(std::next(data_.begin(), ind));
+            ++modifications_;
         }
 
         // ----------------------------------------------------------------------
 
       private:
         std::vector<Element> data_{};
+        size_t modifications_{0};
+
+        void attach()
+        {
+            for (auto& element : data_)
+                element.container_.counter = &modifications_;
+        }
     };
 
     // ----------------------------------------------------------------------
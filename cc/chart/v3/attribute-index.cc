@@ -0,0 +1,144 @@
+#include "chart/v3/attribute-index.hh"
+
+// ----------------------------------------------------------------------
+
+template <typename AgSr> ae::chart::v3::attribute_index_t<AgSr>::attribute_index_t(const AgSr& ag_sr)
+{
+    const auto number_of_elements = *ag_sr.size();
+    passage_flags_.resize(number_of_elements, 0);
+    if constexpr (std::is_same_v<AgSr, Antigens>)
+        dates_.resize(number_of_elements, 0);
+
+    for (size_t no = 0; no < number_of_elements; ++no) {
+        const auto& element = ag_sr[typename AgSr::index_t{no}];
+
+        for (const auto clade : element.semantic().clades()) {
+            auto [pos, inserted] = clade_ids_.try_emplace(std::string{clade}, clade_names_.size());
+            if (inserted) {
+                clade_names_.emplace_back(clade);
+                clade_members_.emplace_back(number_of_elements);
+            }
+            clade_members_[pos->second].set(no);
+        }
+
+        if (element.passage().is_egg())
+            passage_flags_[no] |= flag_egg;
+        if (element.passage().is_cell())
+            passage_flags_[no] |= flag_cell;
+        if (!element.reassortant().empty())
+            passage_flags_[no] |= flag_reassortant;
+
+        if constexpr (std::is_same_v<AgSr, Antigens>) {
+            if (const auto date = date_to_int(*element.date()); date.has_value())
+                dates_[no] = *date;
+            else
+                unparsed_dates_.emplace_back(no, element.date());
+        }
+    }
+
+} // ae::chart::v3::attribute_index_t<AgSr>::attribute_index_t
+
+// ----------------------------------------------------------------------
+
+template <typename AgSr> std::optional<uint32_t> ae::chart::v3::attribute_index_t<AgSr>::date_to_int(std::string_view date)
+{
+    if (date.empty())
+        return 0;
+
+    const auto digits = [date](size_t first, size_t count) -> std::optional<uint32_t> {
+        uint32_t result{0};
+        for (const auto cc : date.substr(first, count)) {
+            if (cc < '0' || cc > '9')
+                return std::nullopt;
+            result = result * 10 + static_cast<uint32_t>(cc - '0');
+        }
+        return result;
+    };
+
+    std::optional<uint32_t> year, month{0}, day{0};
+    switch (date.size()) {
+        case 10:
+            if (date[7] != '-')
+                return std::nullopt;
+            day = digits(8, 2);
+            [[fallthrough]];
+        case 7:
+            if (date[4] != '-')
+                return std::nullopt;
+            month = digits(5, 2);
+            [[fallthrough]];
+        case 4:
+            year = digits(0, 4);
+            break;
+        default:
+            return std::nullopt;
+    }
+    if (!year || !month || !day)
+        return std::nullopt;
+    return *year * 10000 + *month * 100 + *day;
+
+} // ae::chart::v3::attribute_index_t<AgSr>::date_to_int
+
+// ----------------------------------------------------------------------
+
+template <typename AgSr> ae::chart::v3::selection_bits_t ae::chart::v3::attribute_index_t<AgSr>::clade(std::string_view clade) const
+{
+    if (const auto found = clade_ids_.find(clade); found != clade_ids_.end())
+        return clade_members_[found->second];
+    return selection_bits_t{size()};
+
+} // ae::chart::v3::attribute_index_t<AgSr>::clade
+
+// ----------------------------------------------------------------------
+
+template <typename AgSr> ae::chart::v3::selection_bits_t ae::chart::v3::attribute_index_t<AgSr>::any_clade(const std::vector<std::string>& clades) const
+{
+    selection_bits_t result{size()};
+    for (const auto& clade_name : clades) {
+        if (const auto found = clade_ids_.find(clade_name); found != clade_ids_.end())
+            result |= clade_members_[found->second];
+    }
+    return result;
+
+} // ae::chart::v3::attribute_index_t<AgSr>::any_clade
+
+// ----------------------------------------------------------------------
+
+template <typename AgSr> ae::chart::v3::selection_bits_t ae::chart::v3::attribute_index_t<AgSr>::with_flag(uint8_t flag) const
+{
+    selection_bits_t result{size()};
+    for (size_t no = 0; no < passage_flags_.size(); ++no) {
+        if (passage_flags_[no] & flag)
+            result.set(no);
+    }
+    return result;
+
+} // ae::chart::v3::attribute_index_t<AgSr>::with_flag
+
+// ----------------------------------------------------------------------
+
+template <typename AgSr> ae::chart::v3::selection_bits_t ae::chart::v3::attribute_index_t<AgSr>::date_range(std::string_view first_date, std::string_view after_last_date) const
+{
+    const auto first = date_to_int(first_date), after_last = date_to_int(after_last_date);
+    if (!first || !after_last)
+        throw std::invalid_argument{fmt::format("attribute_index_t::date_range: unrecognized date format: \"{}\" \"{}\", YYYY-MM-DD, YYYY-MM or YYYY expected", first_date, after_last_date)};
+
+    selection_bits_t result{size()};
+    for (size_t no = 0; no < dates_.size(); ++no) {
+        if (const auto date = dates_[no]; date != 0 && date >= *first && (*after_last == 0 || date < *after_last))
+            result.set(no);
+    }
+    for (const auto& [no, date] : unparsed_dates_) {
+        if (within_range(date, first_date, after_last_date))
+            result.set(no);
+    }
+    return result;
+
+} // ae::chart::v3::attribute_index_t<AgSr>::date_range
+
+// ======================================================================
+
+template class ae::chart::v3::attribute_index_t<ae::chart::v3::Antigens>;
+template class ae::chart::v3::attribute_index_t<ae::chart::v3::Sera>;
+
+// ======================================================================
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <bit>
+#include <numeric>
+#include <optional>
+#include <unordered_map>
+
+#include "utils/string-hash.hh"
+#include "chart/v3/antigens.hh"
+
+// ----------------------------------------------------------------------
+
+namespace ae::chart::v3
+{
+    // Set of antigen or serum indexes stored as a bitset. Selections by
+    // different attributes are combined with &, | and ~.
+    class selection_bits_t
+    {
+      public:
+        selection_bits_t() = default;
+        explicit selection_bits_t(size_t size, bool value = false) : size_{size}, words_((size + word_bits - 1) / word_bits, value ? ~uint64_t{0} : uint64_t{0}) { clear_tail(); }
+        bool operator==(const selection_bits_t&) const = default;
+
+        size_t size() const { return size_; }
+        bool operator[](size_t no) const { return (words_[no / word_bits] >> (no % word_bits)) & 1; }
+        void set(size_t no) { words_[no / word_bits] |= uint64_t{1} << (no % word_bits); }
+
+        size_t count() const
+        {
+            return std::accumulate(words_.begin(), words_.end(), size_t{0}, [](size_t sum, uint64_t word) { return sum + static_cast<size_t>(std::popcount(word)); });
+        }
+
+        selection_bits_t& operator&=(const selection_bits_t& rhs)
+        {
+            check_size(rhs);
+            for (size_t no = 0; no < words_.size(); ++no)
+                words_[no] &= rhs.words_[no];
+            return *this;
+        }
+
+        selection_bits_t& operator|=(const selection_bits_t& rhs)
+        {
+            check_size(rhs);
+            for (size_t no = 0; no < words_.size(); ++no)
+                words_[no] |= rhs.words_[no];
+            return *this;
+        }
+
+        selection_bits_t operator~() const
+        {
+            selection_bits_t result{*this};
+            for (auto& word : result.words_)
+                word = ~word;
+            result.clear_tail();
+            return result;
+        }
+
+        friend selection_bits_t operator&(selection_bits_t lhs, const selection_bits_t& rhs) { return lhs &= rhs; }
+        friend selection_bits_t operator|(selection_bits_t lhs, const selection_bits_t& rhs) { return lhs |= rhs; }
+
+        // indexes of the set bits in ascending order
+        template <typename Indexes> Indexes to_indexes() const
+        {
+            Indexes result;
+            for (size_t word_no = 0; word_no < words_.size(); ++word_no) {
+                for (auto word = words_[word_no]; word != 0; word &= word - 1)
+                    result.push_back(typename Indexes::value_type{word_no * word_bits + static_cast<size_t>(std::countr_zero(word))});
+            }
+            return result;
+        }
+
+      private:
+        static constexpr size_t word_bits = 64;
+
+        size_t size_{0};
+        std::vector<uint64_t> words_{};
+
+        void clear_tail()
+        {
+            if (const auto tail = size_ % word_bits; tail != 0)
+                words_.back() &= (uint64_t{1} << tail) - 1;
+        }
+
+        void check_size(const selection_bits_t& rhs) const
+        {
+            if (rhs.size_ != size_)
+                throw std::invalid_argument{fmt::format("selection_bits_t: cannot combine selections of different size: {} and {}", size_, rhs.size_)};
+        }
+    };
+
+    // ----------------------------------------------------------------------
+
+    // Columnar index of antigen/serum attributes used in selections:
+    // clades are interned and kept as a bitset per clade, passage types
+    // as flags, antigen dates as yyyymmdd integers. Built from the
+    // current state of antigens/sera, see Chart::attributes().
+    template <typename AgSr> class attribute_index_t
+    {
+      public:
+        explicit attribute_index_t(const AgSr& ag_sr);
+
+        size_t size() const { return passage_flags_.size(); }
+
+        selection_bits_t all() const { return selection_bits_t{size(), true}; }
+        selection_bits_t clade(std::string_view clade) const;
+        selection_bits_t any_clade(const std::vector<std::string>& clades) const;
+        selection_bits_t egg() const { return with_flag(flag_egg); }
+        selection_bits_t cell() const { return with_flag(flag_cell); }
+        selection_bits_t reassortant() const { return with_flag(flag_reassortant); }
+        // antigens only, the same as within_range() for each antigen date
+        selection_bits_t date_range(std::string_view first_date, std::string_view after_last_date) const;
+
+        const std::vector<std::string>& clades() const { return clade_names_; }
+
+        // "2020-05-17" -> 20200517, "2020-05" -> 20200500, "2020" -> 20200000, "" -> 0; this preserves the string ordering used by within_range()
+        static std::optional<uint32_t> date_to_int(std::string_view date);
+
+      private:
+        enum flags : uint8_t { flag_egg = 1, flag_cell = 2, flag_reassortant = 4 };
+
+        std::vector<std::string> clade_names_{};                                                                        // clade id -> name
+        std::unordered_map<std::string, size_t, string_hash_for_unordered_map, std::equal_to<>> clade_ids_{};           // name -> clade id
+        std::vector<selection_bits_t> clade_members_{};                                                                 // clade id -> antigens/sera having the clade
+        std::vector<uint8_t> passage_flags_{};
+        std::vector<uint32_t> dates_{};                                                                                 // antigens only, 0: no date
+        std::vector<std::pair<size_t, Date>> unparsed_dates_{};                                                         // dates in unrecognized format, compared as strings
+
+        selection_bits_t with_flag(uint8_t flag) const;
+    };
+
+    extern template class attribute_index_t<Antigens>;
+    extern template class attribute_index_t<Sera>;
+
+} // namespace ae::chart::v3
+
+// ----------------------------------------------------------------------
@@ -0,0 +1,326 @@
+#include <fstream>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <functional>
+
+#include "utils/timeit.hh"
+#include "ext/simdjson.hh"
+#include "chart/v3/chart.hh"
+#include "chart/v3/chart-binary.hh"
+
+// ----------------------------------------------------------------------
+
+namespace ae::chart::v3::binary
+{
+    static_assert(std::endian::native == std::endian::little, "binary chart format is little endian");
+    static_assert(sizeof(header_t) == 16 && sizeof(section_t) == 24 && sizeof(titers_header_t) == 32 && sizeof(layout_header_t) == 16);
+
+    constexpr size_t alignment{8};
+    constexpr uint64_t max_number_of_dimensions{64}; // far above any map, rejects garbage in the layout header
+
+    template <typename T> inline void append(std::string& out, const T& data) { out.append(reinterpret_cast<const char*>(&data), sizeof(T)); }
+    template <typename T> inline void append(std::string& out, std::span<const T> data) { out.append(reinterpret_cast<const char*>(data.data()), data.size_bytes()); }
+    inline void align(std::string& out) { out.resize((out.size() + alignment - 1) / alignment * alignment, '\0'); }
+
+    // section data is aligned within the file, offset and size come from the file and are not trusted
+    template <typename T> inline std::span<const T> array_at(std::string_view data, size_t offset, size_t size)
+    {
+        if (offset > data.size() || size > (data.size() - offset) / sizeof(T))
+            throw Error{"binary chart: section is truncated"};
+        return {reinterpret_cast<const T*>(data.data() + offset), size};
+    }
+
+    // sections are collected in body, offsets are fixed up by finish() when the size of the section table is known
+    class builder_t
+    {
+      public:
+        template <typename Fill> void add(section_type type, size_t number, Fill&& fill)
+        {
+            align(body_);
+            const auto offset = body_.size();
+            fill(body_);
+            sections_.push_back(section_t{.type = type, .number = static_cast<uint32_t>(number), .offset = offset, .size = body_.size() - offset});
+        }
+
+        std::string finish();
+
+      private:
+        std::vector<section_t> sections_{};
+        std::string body_{};
+    };
+
+    static void append_titers(std::string& out, const Titers::sparse_t& titers, serum_index number_of_sera);
+    static void append_layout(std::string& out, const Layout& layout);
+
+} // namespace ae::chart::v3::binary
+
+// ----------------------------------------------------------------------
+
+bool ae::chart::v3::binary::is_binary(std::string_view data)
+{
+    return data.substr(0, magic.size()) == magic;
+
+} // ae::chart::v3::binary::is_binary
+
+// ----------------------------------------------------------------------
+
+bool ae::chart::v3::binary::is_binary_file(const std::filesystem::path& filename)
+{
+    if (filename == "-")
+        return false;
+    std::array<char, magic.size()> buffer;
+    std::ifstream in{filename, std::ios::binary};
+    return in.read(buffer.data(), buffer.size()) && is_binary(std::string_view{buffer.data(), buffer.size()});
+
+} // ae::chart::v3::binary::is_binary_file
+
+// ----------------------------------------------------------------------
+
+void ae::chart::v3::binary::append_titers(std::string& out, const Titers::sparse_t& titers, serum_index number_of_sera)
+{
+    append(out, titers_header_t{.number_of_antigens = titers.size(), .number_of_sera = *number_of_sera, .number_of_entries = titers.number_of_entries(), .dense = 0, .reserved = 0});
+    for (const auto offset : titers.row_offsets())
+        append(out, static_cast<uint64_t>(offset));
+    for (const auto sr_no : titers.sera())
+        append(out, static_cast<uint32_t>(*sr_no));
+    for (const auto& titer : titers.titers())
+        append(out, titer.encoded());
+
+} // ae::chart::v3::binary::append_titers
+
+// ----------------------------------------------------------------------
+
+void ae::chart::v3::binary::append_layout(std::string& out, const Layout& layout)
+{
+    append(out, layout_header_t{.number_of_points = *layout.number_of_points(), .number_of_dimensions = *layout.number_of_dimensions()});
+    append(out, layout.span());
+
+} // ae::chart::v3::binary::append_layout
+
+// ----------------------------------------------------------------------
+
+std::string ae::chart::v3::binary::builder_t::finish()
+{
+    std::string result;
+    append(result, header_t{.magic = {}, .version = version, .number_of_sections = static_cast<uint32_t>(sections_.size())});
+    std::memcpy(result.data(), magic.data(), magic.size());
+    const auto body_offset = result.size() + sections_.size() * sizeof(section_t); // multiple of alignment
+    for (auto& section : sections_) {
+        section.offset += body_offset;
+        append(result, section);
+    }
+    result.append(body_);
+    return result;
+
+} // ae::chart::v3::binary::builder_t::finish
+
+// ----------------------------------------------------------------------
+
+std::string ae::chart::v3::Chart::export_to_binary() const
+{
+    using namespace binary;
+
+    builder_t builder;
+    builder.add(section_type::metadata, 0, [this](std::string& out) { out.append(export_to_json(export_bulk_data::no)); });
+
+    builder.add(section_type::titers, 0, [this](std::string& out) {
+        if (titers().is_dense()) {
+            append(out, titers_header_t{.number_of_antigens = *titers().number_of_antigens(), .number_of_sera = *titers().number_of_sera(), .number_of_entries = 0, .dense = 1, .reserved = 0});
+            for (const auto& titer : titers().dense_titers())
+                append(out, titer.encoded());
+        }
+        else
+            append_titers(out, titers().sparse_titers(), titers().number_of_sera());
+    });
+    for (const auto layer_no : titers().number_of_layers())
+        builder.add(section_type::titers, *layer_no + 1, [this, layer_no](std::string& out) { append_titers(out, titers().layer(layer_no), titers().number_of_sera()); });
+
+    for (const auto projection_no : projections().size())
+        builder.add(section_type::layout, *projection_no, [this, projection_no](std::string& out) { append_layout(out, projections()[projection_no].layout()); });
+
+    return builder.finish();
+
+} // ae::chart::v3::Chart::export_to_binary
+
+// ----------------------------------------------------------------------
+
+std::string ae::chart::v3::binary::export_layouts(std::string_view metadata, const Projections& projections, projection_index first)
+{
+    builder_t builder;
+    builder.add(section_type::metadata, 0, [metadata](std::string& out) { out.append(metadata); });
+    for (auto projection_no = first; projection_no < projections.size(); ++projection_no)
+        builder.add(section_type::layout, *(projection_no - first), [&projections, projection_no](std::string& out) { append_layout(out, projections[projection_no].layout()); });
+    return builder.finish();
+
+} // ae::chart::v3::binary::export_layouts
+
+// ----------------------------------------------------------------------
+
+void ae::chart::v3::Chart::read_binary(const binary::view_t& view)
+{
+    using namespace binary;
+
+    {
+        ae::simdjson::Parser parser{view.metadata()};
+        try {
+            read(parser, chart_import::complete);
+        }
+        catch (::simdjson::simdjson_error& err) {
+            throw Error{"binary chart metadata parsing error: {} at {} \"{}\"\n", err.what(), parser.current_location_offset(), parser.current_location_snippet(50)};
+        }
+    }
+
+    const auto read_sparse = [](std::string_view data, const titers_header_t& header) {
+        const auto row_offsets = array_at<uint64_t>(data, sizeof(header), header.number_of_antigens + 1);
+        const auto sera = array_at<uint32_t>(data, sizeof(header) + row_offsets.size_bytes(), header.number_of_entries);
+        const auto titers = array_at<uint32_t>(data, sizeof(header) + row_offsets.size_bytes() + sera.size_bytes(), header.number_of_entries);
+        if (row_offsets[0] != 0 || row_offsets.back() > header.number_of_entries || std::adjacent_find(row_offsets.begin(), row_offsets.end(), std::greater<>{}) != row_offsets.end())
+            throw Error{"binary chart: invalid titer row offsets"};
+        if (std::any_of(sera.begin(), sera.end(), [&header](uint32_t sr_no) { return sr_no >= header.number_of_sera; }))
+            throw Error{"binary chart: invalid serum index in titers"};
+        sparse_titers_builder_t builder;
+        builder.reserve(header.number_of_entries);
+        for (size_t ag_no = 0; ag_no < header.number_of_antigens; ++ag_no) {
+            const auto antigen_no = builder.add_antigen();
+            for (auto entry_no = row_offsets[ag_no]; entry_no < row_offsets[ag_no + 1]; ++entry_no)
+                builder.add(antigen_no, serum_index{sera[entry_no]}, Titer::from_encoded(titers[entry_no]));
+        }
+        return builder.build();
+    };
+
+    auto& target = titers();
+    for (const auto& sec : view.sections()) {
+        switch (sec.type) {
+            case section_type::titers: {
+                const auto data = view.section_data(sec);
+                const auto& header = array_at<titers_header_t>(data, 0, 1)[0];
+                if (header.number_of_antigens != *antigens().size() || header.number_of_sera != *sera().size())
+                    throw Error{"binary chart: titer table size {}x{} does not match number of antigens and sera {}x{}", header.number_of_antigens, header.number_of_sera, antigens().size(), sera().size()};
+                if (sec.number == 0) {
+                    if (header.dense) {
+                        auto& dense = target.create_dense_titers();
+                        const auto encoded = array_at<uint32_t>(data, sizeof(header), header.number_of_antigens * header.number_of_sera);
+                        dense.reserve(encoded.size());
+                        std::transform(encoded.begin(), encoded.end(), std::back_inserter(dense), &Titer::from_encoded);
+                    }
+                    else
+                        target.create_sparse_titers() = read_sparse(data, header);
+                    target.number_of_sera(sera().size());
+                }
+                else {
+                    if (target.number_of_layers() != layer_index{sec.number - 1})
+                        throw Error{"binary chart: unexpected layer {}", sec.number - 1};
+                    target.layers().push_back(read_sparse(data, header));
+                }
+            } break;
+            case section_type::layout: {
+                const projection_index projection_no{sec.number};
+                if (projection_no >= projections().size())
+                    throw Error{"binary chart: layout for invalid projection {}", projection_no};
+                const auto& header = array_at<layout_header_t>(view.section_data(sec), 0, 1)[0];
+                if (header.number_of_points != *number_of_points())
+                    throw Error{"binary chart: layout of projection {} has {} points, chart has {}", projection_no, header.number_of_points, number_of_points()};
+                if (header.number_of_dimensions == 0 || header.number_of_dimensions > max_number_of_dimensions)
+                    throw Error{"binary chart: layout of projection {}: invalid number of dimensions {}", projection_no, header.number_of_dimensions};
+                const auto layout = view.layout(projection_no);
+                projections()[projection_no].layout() = Layout{view.number_of_dimensions(projection_no), layout.data(), layout.data() + layout.size()};
+            } break;
+            case section_type::metadata:
+                break;
+        }
+    }
+
+} // ae::chart::v3::Chart::read_binary
+
+// ----------------------------------------------------------------------
+
+ae::chart::v3::binary::view_t::view_t(const std::filesystem::path& filename)
+    : mapped_{std::make_unique<file::mmapped>(filename)}, data_{*mapped_}
+{
+    read_header();
+
+} // ae::chart::v3::binary::view_t::view_t
+
+// ----------------------------------------------------------------------
+
+ae::chart::v3::binary::view_t::view_t(std::string_view data)
+    : data_{data}
+{
+    if (reinterpret_cast<uintptr_t>(data_.data()) % alignment)
+        throw Error{"binary chart: data is not aligned"};
+    read_header();
+
+} // ae::chart::v3::binary::view_t::view_t
+
+// ----------------------------------------------------------------------
+
+void ae::chart::v3::binary::view_t::read_header()
+{
+    if (!is_binary(data_))
+        throw Error{"binary chart: invalid magic"};
+    const auto& header = array_at<header_t>(data_, 0, 1)[0];
+    if (header.version != version)
+        throw Error{"binary chart: unsupported version {}", header.version};
+    sections_ = array_at<section_t>(data_, sizeof(header_t), header.number_of_sections);
+    for (const auto& section : sections_) {
+        if (section.offset % alignment || section.offset > data_.size() || section.size > data_.size() - section.offset)
+            throw Error{"binary chart: invalid section at {}", section.offset};
+    }
+
+} // ae::chart::v3::binary::view_t::read_header
+
+// ----------------------------------------------------------------------
+
+const ae::chart::v3::binary::section_t& ae::chart::v3::binary::view_t::find(section_type type, uint32_t number) const
+{
+    if (const auto found = std::find_if(sections_.begin(), sections_.end(), [type, number](const auto& section) { return section.type == type && section.number == number; }); found != sections_.end())
+        return *found;
+    throw Error{"binary chart: no section {}:{}", static_cast<uint32_t>(type), number};
+
+} // ae::chart::v3::binary::view_t::find
+
+// ----------------------------------------------------------------------
+
+std::string_view ae::chart::v3::binary::view_t::metadata() const
+{
+    return section_data(find(section_type::metadata, 0));
+
+} // ae::chart::v3::binary::view_t::metadata
+
+// ----------------------------------------------------------------------
+
+ae::projection_index ae::chart::v3::binary::view_t::number_of_projections() const
+{
+    return projection_index{static_cast<size_t>(std::count_if(sections_.begin(), sections_.end(), [](const auto& section) { return section.type == section_type::layout; }))};
+
+} // ae::chart::v3::binary::view_t::number_of_projections
+
+// ----------------------------------------------------------------------
+
+const ae::chart::v3::binary::layout_header_t& ae::chart::v3::binary::view_t::layout_header(projection_index projection_no) const
+{
+    return array_at<layout_header_t>(section_data(find(section_type::layout, static_cast<uint32_t>(*projection_no))), 0, 1)[0];
+
+} // ae::chart::v3::binary::view_t::layout_header
+
+// ----------------------------------------------------------------------
+
+ae::number_of_dimensions_t ae::chart::v3::binary::view_t::number_of_dimensions(projection_index projection_no) const
+{
+    return number_of_dimensions_t{layout_header(projection_no).number_of_dimensions};
+
+} // ae::chart::v3::binary::view_t::number_of_dimensions
+
+// ----------------------------------------------------------------------
+
+std::span<const double> ae::chart::v3::binary::view_t::layout(projection_index projection_no) const
+{
+    const auto& header = layout_header(projection_no);
+    if (header.number_of_dimensions != 0 && header.number_of_points > std::numeric_limits<size_t>::max() / header.number_of_dimensions)
+        throw Error{"binary chart: invalid layout size"};
+    return array_at<double>(section_data(find(section_type::layout, static_cast<uint32_t>(*projection_no))), sizeof(layout_header_t), header.number_of_points * header.number_of_dimensions);
+
+} // ae::chart::v3::binary::view_t::layout
+
+// ----------------------------------------------------------------------
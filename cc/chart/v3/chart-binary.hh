@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <memory>
+#include <vector>
+
+#include "utils/file.hh"
+#include "chart/v3/index.hh"
+
+// ----------------------------------------------------------------------
+
+namespace ae::chart::v3
+{
+    class Projections;
+}
+
+namespace ae::chart::v3::binary
+{
+    // Binary chart container (.acb), written by Chart::export_to_binary()
+    // and Chart::write(), imported by Chart(filename) and Chart(data) when
+    // the magic is found. Integers and doubles are in the native (little
+    // endian) byte order, the file is not compressed to be memory mapped.
+    //
+    //  header_t
+    //  section_t[header_t::number_of_sections]
+    //  sections, each starts at an 8 byte boundary:
+    //   metadata | .ace json without titers and projection layouts
+    //   titers   | number 0: main table, number 1 + layer_no: layer
+    //            | titers_header_t, then
+    //            |   dense: uint32 encoded titer [number_of_antigens * number_of_sera]
+    //            |   sparse (CSR): uint64 row offset [number_of_antigens + 1], uint32 serum [number_of_entries], uint32 encoded titer [number_of_entries]
+    //   layout   | number: projection index
+    //            | layout_header_t, float64 coordinates [number_of_points * number_of_dimensions], NaN for points without coordinates
+
+    inline constexpr std::string_view magic{"\x89" "ACB\r\n\x1a\n", 8};
+    inline constexpr uint32_t version{1};
+
+    enum class section_type : uint32_t { metadata = 1, titers = 2, layout = 3 };
+
+    struct header_t
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t number_of_sections;
+    };
+
+    struct section_t
+    {
+        section_type type;
+        uint32_t number;
+        uint64_t offset; // from the beginning of the file
+        uint64_t size;
+    };
+
+    struct titers_header_t
+    {
+        uint64_t number_of_antigens;
+        uint64_t number_of_sera;
+        uint64_t number_of_entries; // sparse only
+        uint32_t dense;
+        uint32_t reserved;
+    };
+
+    struct layout_header_t
+    {
+        uint64_t number_of_points;
+        uint64_t number_of_dimensions;
+    };
+
+    bool is_binary(std::string_view data);
+    bool is_binary_file(const std::filesystem::path& filename);
+
+    // Container with the caller's metadata and the layouts of projections
+    // starting with first (numbered from 0) but without titers, e.g. relax
+    // cache entries (chart/v3/relax-cache.hh)
+    std::string export_layouts(std::string_view metadata, const Projections& projections, projection_index first);
+
+    // ----------------------------------------------------------------------
+
+    // Binary chart, either memory mapped or referring to the data owned
+    // by the caller, layouts are accessed without copying
+    class view_t
+    {
+      public:
+        explicit view_t(const std::filesystem::path& filename);
+        explicit view_t(std::string_view data);
+
+        std::span<const section_t> sections() const { return sections_; }
+        std::string_view metadata() const;
+        std::string_view section_data(const section_t& section) const { return data_.substr(section.offset, section.size); }
+
+        projection_index number_of_projections() const;
+        number_of_dimensions_t number_of_dimensions(projection_index projection_no) const;
+        std::span<const double> layout(projection_index projection_no) const;
+
+      private:
+        std::unique_ptr<file::mmapped> mapped_{};
+        std::string_view data_{};
+        std::span<const section_t> sections_{};
+
+        void read_header();
+        const section_t& find(section_type type, uint32_t number) const;
+        const layout_header_t& layout_header(projection_index projection_no) const;
+    };
+
+} // namespace ae::chart::v3::binary
+
+// ----------------------------------------------------------------------
@@ -1,3 +1,4 @@
+#include "ext/omp.hh"
 #include "utils/log.hh"
 #include "utils/timeit.hh"
 #include "utils/file.hh"
@@ -57,13 +58,6 @@ const auto put_int = [](fmt::memory_buffer& out, auto value, auto&& condition, s
     return comma;
 };
 
-const auto double_to_str = [](auto value) -> std::string {
-    if constexpr (std::is_convertible_v<decltype(value), double>)
-        return ae::format_double(value);
-    else
-        return ae::format_double(*value);
-};
-
 const auto put_bool = [](fmt::memory_buffer& out, bool value, bool dflt, std::string_view key, bool comma, std::string_view after_comma = {}) -> bool {
     if (value != dflt) {
         comma = put_comma_key(out, comma, key, after_comma);
@@ -76,7 +70,7 @@ const auto put_optional = []<typename Value>(fmt::memory_buffer& out, const std:
     if (value.has_value()) {
         comma = put_comma_key(out, comma, key, after_comma);
         if constexpr (std::is_same_v<Value, double>)
-            fmt::format_to(std::back_inserter(out), "{}", double_to_str(*value));
+            ae::format_double_to(out, *value);
         else if constexpr (std::is_same_v<Value, std::string> || std::is_same_v<Value, std::string_view>)
             format_str(out, *value);
         else if constexpr (std::is_same_v<Value, ae::chart::v3::semantic::color_t>)
@@ -93,7 +87,7 @@ const auto put_double = [](fmt::memory_buffer& out, double value, auto&& conditi
 {
     if (condition(value)) {
         comma = put_comma_key(out, comma, key, after_comma);
-        fmt::format_to(std::back_inserter(out), "{}", double_to_str(value));
+        ae::format_double_to(out, value);
     }
     return comma;
 };
@@ -124,7 +118,7 @@ const auto put_array_double = [](fmt::memory_buffer& out, const auto& value, aut
         bool comma2 = false;
         for (const auto en : value) {
             comma2 = put_comma(out, comma2);
-            fmt::format_to(std::back_inserter(out), "{}", double_to_str(en));
+            ae::format_double_to(out, en);
         }
         fmt::format_to(std::back_inserter(out), "]");
     }
@@ -457,10 +451,39 @@ static inline void export_legacy_plot_spec(fmt::memory_buffer& out, const ae::ch
 
 // ----------------------------------------------------------------------
 
-std::string ae::chart::v3::Chart::export_to_json() const
+std::string ae::chart::v3::Chart::export_to_json(layout_precision precision) const
+{
+    std::string result;
+    export_to_json(export_bulk_data::yes, [&result](std::string_view chunk) { result.append(chunk); }, precision);
+    return result;
+
+} // ae::chart::v3::Chart::export_to_json
+
+// ----------------------------------------------------------------------
+
+std::string ae::chart::v3::Chart::export_to_json(export_bulk_data bulk_data) const
+{
+    std::string result;
+    export_to_json(bulk_data, [&result](std::string_view chunk) { result.append(chunk); });
+    return result;
+
+} // ae::chart::v3::Chart::export_to_json
+
+// ----------------------------------------------------------------------
+
+void ae::chart::v3::Chart::export_to_json(export_bulk_data bulk_data, const ae::file::chunk_sink_t& sink, layout_precision precision) const
 {
     fmt::memory_buffer out;
 
+    // passes accumulated output to sink after an antigen, serum, titer row or projection when it exceeds the chunk size
+    constexpr size_t chunk_size{1024 * 1024};
+    const auto flush = [&out, &sink](bool force = false) {
+        if (out.size() >= chunk_size || (force && out.size() > 0)) {
+            sink(std::string_view{out.data(), out.size()});
+            out.clear();
+        }
+    };
+
     // ----------------------------------------------------------------------
 
     fmt::format_to(std::back_inserter(out), R"({{"_": "-*- js-indent-level: 1 -*-",
@@ -544,6 +567,7 @@ std::string ae::chart::v3::Chart::export_to_json() const
         comma4 = put_insertions(out, antigen.aa_insertions(), "Ai", comma4);
         comma4 = put_insertions(out, antigen.nuc_insertions(), "Bi", comma4);
         fmt::format_to(std::back_inserter(out), "}}");
+        flush();
     }
     fmt::format_to(std::back_inserter(out), "\n  ]");
 
@@ -585,6 +609,7 @@ std::string ae::chart::v3::Chart::export_to_json() const
         comma6 = put_insertions(out, serum.aa_insertions(), "Ai", comma6);
         comma6 = put_insertions(out, serum.nuc_insertions(), "Bi", comma6);
         fmt::format_to(std::back_inserter(out), "}}");
+        flush();
     }
     fmt::format_to(std::back_inserter(out), "\n  ]");
 
@@ -593,53 +618,81 @@ std::string ae::chart::v3::Chart::export_to_json() const
     //  "d" | array of key(str)-value(str) | sparse matrix, entry for each antigen present, key is serum index, value is titer, dont-care titers omitted
     //  "L" | array of arrays of key-value | layers of titers, each top level array element as in "d" or "l"
 
-    const auto put_sparse = [&out, this](const Titers::sparse_t& data, std::string_view indent) {
+    // target is either out or a buffer of put_parallel(), the latter must not be flushed
+    const auto put_sparse = [&out, &flush, this](fmt::memory_buffer& target, const Titers::sparse_t& data, std::string_view indent) {
         for (const auto ag_no : titers().number_of_antigens()) {
             if (ag_no != antigen_index{0})
-                fmt::format_to(std::back_inserter(out), ",");
-            fmt::format_to(std::back_inserter(out), "\n{}{{", indent);
+                fmt::format_to(std::back_inserter(target), ",");
+            fmt::format_to(std::back_inserter(target), "\n{}{{", indent);
             bool comma = false;
             for (const auto& [sr_no, titer] : data[*ag_no]) {
-                comma = put_comma(out, comma);
-                fmt::format_to(std::back_inserter(out), "\"{}\":\"{}\"", sr_no, titer);
+                comma = put_comma(target, comma);
+                fmt::format_to(std::back_inserter(target), "\"{}\":\"{}\"", sr_no, titer);
             }
-            fmt::format_to(std::back_inserter(out), "}}");
+            fmt::format_to(std::back_inserter(target), "}}");
+            if (&target == &out)
+                flush();
         }
     };
 
-    fmt::format_to(std::back_inserter(out), ",\n  \"t\": {{");
-    if (titers().is_dense()) {
-        fmt::format_to(std::back_inserter(out), "\n   \"l\": [");
-        for (const auto ag_no : titers().number_of_antigens()) {
-            if (ag_no != antigen_index{0})
-                fmt::format_to(std::back_inserter(out), ",");
-            fmt::format_to(std::back_inserter(out), "\n    [");
-            for (const auto sr_no : titers().number_of_sera()) {
-                if (sr_no != serum_index{0})
+    // Formats independent items (titer layers, projections) into separate
+    // buffers in parallel and appends them to out in order, separated by
+    // commas, output is the same as produced serially. Items are processed
+    // in batches to keep memory use bounded.
+    const auto put_parallel = [&out, &flush](size_t number_of_items, auto&& put_item) {
+        const auto batch_size = static_cast<size_t>(omp_get_max_threads()) * 4;
+        std::vector<fmt::memory_buffer> buffers(std::min(batch_size, number_of_items));
+        for (size_t first = 0; first < number_of_items; first += batch_size) {
+            const auto last = std::min(first + batch_size, number_of_items);
+#pragma omp parallel for default(shared) schedule(dynamic) if (last - first > 1)
+            for (size_t item_no = first; item_no < last; ++item_no) {
+                buffers[item_no - first].clear();
+                put_item(buffers[item_no - first], item_no);
+            }
+            for (size_t item_no = first; item_no < last; ++item_no) {
+                if (item_no != 0)
                     fmt::format_to(std::back_inserter(out), ",");
-                fmt::format_to(std::back_inserter(out), "{:>7s}", fmt::format("\"{}\"", titers().titer(ag_no, sr_no)));
+                const auto& buffer = buffers[item_no - first];
+                out.append(buffer.data(), buffer.data() + buffer.size());
+                flush();
             }
-            fmt::format_to(std::back_inserter(out), "]");
         }
-        fmt::format_to(std::back_inserter(out), "\n   ]");
-    }
-    else {
-        fmt::format_to(std::back_inserter(out), "\n   \"d\": [");
-        put_sparse(titers().sparse_titers(), "    ");
-        fmt::format_to(std::back_inserter(out), "\n   ]");
-    }
-    if (titers().number_of_layers() > layer_index{1}) {
-        fmt::format_to(std::back_inserter(out), ",\n   \"L\": [");
-        for (const auto layer_no : titers().number_of_layers()) {
-            if (layer_no != layer_index{0})
-                fmt::format_to(std::back_inserter(out), ",");
-            fmt::format_to(std::back_inserter(out), "\n    [");
-            put_sparse(titers().layer(layer_no), "     ");
-            fmt::format_to(std::back_inserter(out), "\n    ]");
+    };
+
+    if (bulk_data == export_bulk_data::yes) { // titers are stored separately in the binary format
+        fmt::format_to(std::back_inserter(out), ",\n  \"t\": {{");
+        if (titers().is_dense()) {
+            fmt::format_to(std::back_inserter(out), "\n   \"l\": [");
+            for (const auto ag_no : titers().number_of_antigens()) {
+                if (ag_no != antigen_index{0})
+                    fmt::format_to(std::back_inserter(out), ",");
+                fmt::format_to(std::back_inserter(out), "\n    [");
+                for (const auto sr_no : titers().number_of_sera()) {
+                    if (sr_no != serum_index{0})
+                        fmt::format_to(std::back_inserter(out), ",");
+                    fmt::format_to(std::back_inserter(out), "{:>7s}", fmt::format("\"{}\"", titers().titer(ag_no, sr_no)));
+                }
+                fmt::format_to(std::back_inserter(out), "]");
+                flush();
+            }
+            fmt::format_to(std::back_inserter(out), "\n   ]");
+        }
+        else {
+            fmt::format_to(std::back_inserter(out), "\n   \"d\": [");
+            put_sparse(out, titers().sparse_titers(), "    ");
+            fmt::format_to(std::back_inserter(out), "\n   ]");
         }
-        fmt::format_to(std::back_inserter(out), "\n   ]");
+        if (titers().number_of_layers() > layer_index{1}) {
+            fmt::format_to(std::back_inserter(out), ",\n   \"L\": [");
+            put_parallel(*titers().number_of_layers(), [&put_sparse, this](fmt::memory_buffer& target, size_t layer_no) {
+                fmt::format_to(std::back_inserter(target), "\n    [");
+                put_sparse(target, titers().layer(layer_index{layer_no}), "     ");
+                fmt::format_to(std::back_inserter(target), "\n    ]");
+            });
+            fmt::format_to(std::back_inserter(out), "\n   ]");
+        }
+        fmt::format_to(std::back_inserter(out), "\n  }}");
     }
-    fmt::format_to(std::back_inserter(out), "\n  }}");
 
     //  "C" |     |     |     | array of floats                  | forced column bases for a new projections
     // stored with sera
@@ -672,45 +725,46 @@ std::string ae::chart::v3::Chart::export_to_json() const
 
     if (!projections().empty()) {
         fmt::format_to(std::back_inserter(out), ",\n  \"P\": [");
-        auto comma7 = false;
-        for (const auto& projection : projections()) {
-            comma7 = put_comma(out, comma7);
-            fmt::format_to(std::back_inserter(out), "\n   {{");
+        put_parallel(*projections().size(), [this, bulk_data, precision](fmt::memory_buffer& target, size_t projection_no) {
+            const auto& projection = projections()[projection_index{projection_no}];
+            fmt::format_to(std::back_inserter(target), "\n   {{");
             auto comma8 = put_double(
-                out, projection.stress(), [](double stress) { return !std::isnan(stress) && stress >= 0.0; }, "s", false);
+                target, projection.stress(), [](double stress) { return !std::isnan(stress) && stress >= 0.0; }, "s", false);
             comma8 = put_str(
-                out, projection.minimum_column_basis(), [](const auto& mcb) { return !mcb.is_none(); }, "m", comma8);
-            comma8 = put_str(out, projection.comment(), not_empty, "c", comma8);
-            comma8 = put_bool(out, projection.dodgy_titer_is_regular() == dodgy_titer_is_regular_e::yes, false, "d", comma8);
-            comma8 = put_array_double(out, projection.forced_column_bases(), not_empty, "C", comma8);
-            comma8 = put_array_double(out, projection.transformation().as_vector(), not_empty, "t", comma8, "\n    ");
-            comma8 = put_array_int(out, projection.unmovable(), not_empty, "U", comma8, "\n    ");
-            comma8 = put_array_int(out, projection.disconnected(), not_empty, "D", comma8, "\n    ");
-            comma8 = put_array_int(out, projection.unmovable_in_the_last_dimension(), not_empty, "u", comma8, "\n    ");
+                target, projection.minimum_column_basis(), [](const auto& mcb) { return !mcb.is_none(); }, "m", comma8);
+            comma8 = put_str(target, projection.comment(), not_empty, "c", comma8);
+            comma8 = put_bool(target, projection.dodgy_titer_is_regular() == dodgy_titer_is_regular_e::yes, false, "d", comma8);
+            comma8 = put_array_double(target, projection.forced_column_bases(), not_empty, "C", comma8);
+            comma8 = put_array_double(target, projection.transformation().as_vector(), not_empty, "t", comma8, "\n    ");
+            comma8 = put_array_int(target, projection.unmovable(), not_empty, "U", comma8, "\n    ");
+            comma8 = put_array_int(target, projection.disconnected(), not_empty, "D", comma8, "\n    ");
+            comma8 = put_array_int(target, projection.unmovable_in_the_last_dimension(), not_empty, "u", comma8, "\n    ");
 
             const auto& layout = projection.layout();
-            comma8 = put_comma(out, comma8);
-            fmt::format_to(std::back_inserter(out), "\n    \"l\": [");
-            for (const auto point_no : layout.number_of_points()) {
-                if (point_no != point_index{0})
-                    fmt::format_to(std::back_inserter(out), ",");
-                fmt::format_to(std::back_inserter(out), "\n     [");
-                if (const auto point = layout[point_no]; point.exists()) {
-                    bool comma9 = false;
-                    for (const auto coord : point) {
-                        comma9 = put_comma(out, comma9);
-                        fmt::format_to(std::back_inserter(out), "{}", ae::format_double(coord));
+            if (bulk_data == export_bulk_data::yes) { // layouts are stored separately in the binary format
+                comma8 = put_comma(target, comma8);
+                fmt::format_to(std::back_inserter(target), "\n    \"l\": [");
+                for (const auto point_no : layout.number_of_points()) {
+                    if (point_no != point_index{0})
+                        fmt::format_to(std::back_inserter(target), ",");
+                    fmt::format_to(std::back_inserter(target), "\n     [");
+                    if (const auto point = layout[point_no]; point.exists()) {
+                        bool comma9 = false;
+                        for (const auto coord : point) {
+                            comma9 = put_comma(target, comma9);
+                            ae::format_double_to(target, coord, static_cast<int>(precision));
+                        }
                     }
+                    fmt::format_to(std::back_inserter(target), "]");
                 }
-                fmt::format_to(std::back_inserter(out), "]");
+                fmt::format_to(std::back_inserter(target), "\n    ]");
             }
-            fmt::format_to(std::back_inserter(out), "\n    ]");
 
             // "g"
             // "f"
             // "e"
-            fmt::format_to(std::back_inserter(out), "\n   }}");
-        }
+            fmt::format_to(std::back_inserter(target), "\n   }}");
+        });
         fmt::format_to(std::back_inserter(out), "\n  ]");
     }
 
@@ -727,18 +781,27 @@ std::string ae::chart::v3::Chart::export_to_json() const
     // fmt::format_to(std::back_inserter(out), "\n  }}");
 
     fmt::format_to(std::back_inserter(out), "\n }}\n}}\n");
-
-    return fmt::to_string(out);
+    flush(true);
 
 } // ae::chart::v3::Chart::export_to_json
 
 // ----------------------------------------------------------------------
 
-void ae::chart::v3::Chart::write(const std::filesystem::path& filename) const
+void ae::chart::v3::Chart::write(const std::filesystem::path& filename, layout_precision precision) const
 {
     // Timeit ti{fmt::format("exporting chart to {}", filename), std::chrono::milliseconds{1000}};
 
-    ae::file::write(filename, export_to_json(), ae::file::force_compression::yes);
+    // output_sink_t replaces the file only when export is complete
+    if (filename.extension() == ".acb") {
+        ae::file::output_sink_t output{filename, ae::file::force_compression::no}; // uncompressed to be memory mapped on import
+        output.append(export_to_binary());
+        output.finish();
+    }
+    else {
+        ae::file::output_sink_t output{filename, ae::file::force_compression::yes};
+        export_to_json(export_bulk_data::yes, output.sink(), precision);
+        output.finish();
+    }
 
 } // ae::chart::v3::Chart::write
 
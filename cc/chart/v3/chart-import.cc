@@ -4,6 +4,7 @@
 #include "utils/timeit.hh"
 #include "utils/collection-json.hh"
 #include "chart/v3/chart.hh"
+#include "chart/v3/chart-binary.hh"
 
 // ----------------------------------------------------------------------
 
@@ -207,17 +208,17 @@ inline void read_sera(ae::chart::v3::Sera& target, simdjson::ondemand::array sou
 inline ae::serum_index read_sparse(ae::chart::v3::Titers::sparse_t& target, simdjson::ondemand::array source)
 {
     ae::serum_index number_of_sera{0};
-    // ae::antigen_index ag_no{0};
+    ae::chart::v3::sparse_titers_builder_t builder;
     for (auto row : source) {
-        auto& target_row = target.emplace_back();
+        const auto ag_no = builder.add_antigen();
         for (auto source_entry : row.get_object()) {
             const ae::serum_index sr_no{ae::from_chars<ae::serum_index::value_type>(static_cast<std::string_view>(source_entry.unescaped_key()))};
-            target_row.emplace_back(sr_no, ae::chart::v3::Titer{static_cast<std::string_view>(source_entry.value())});
+            builder.add(ag_no, sr_no, ae::chart::v3::Titer{static_cast<std::string_view>(source_entry.value())});
             number_of_sera = std::max(number_of_sera, sr_no + ae::serum_index{1});
         }
-        // row is perhaps not sorted by sr_no (produced by ae.chart_v2), sort it
-        std::sort(target_row.begin(), target_row.end(), [](const auto& e1, const auto& e2) { return e1.first < e2.first; });
     }
+    // row is perhaps not sorted by sr_no (produced by ae.chart_v2), builder sorts it
+    target = builder.build();
     return number_of_sera;
 }
 
@@ -841,10 +842,65 @@ inline void read_semantic_plot_specification(ae::chart::v3::semantic::Styles& ta
 
 // ----------------------------------------------------------------------
 
-void ae::chart::v3::Chart::read(ae::simdjson::Parser& parser)
+// returns pointer after the closing bracket of the json object or array starting at first
+inline const char* end_of_json_object_or_array(const char* first, const char* last)
+{
+    size_t depth{0};
+    for (const char* cur = first; cur < last; ++cur) {
+        switch (*cur) {
+            case '"':
+                for (++cur; cur < last && *cur != '"'; ++cur) {
+                    if (*cur == '\\')
+                        ++cur;
+                }
+                break;
+            case '[':
+            case '{':
+                ++depth;
+                break;
+            case ']':
+            case '}':
+                if (--depth == 0)
+                    return cur + 1;
+                break;
+            default:
+                break;
+        }
+    }
+    throw ae::chart::v3::Error{"unterminated json object or array: \"{}\"", std::string_view(first, std::min(50L, last - first))};
+}
+
+// copies json of the section to be parsed later, nullptr if section is not an object or array (parse it immediately then)
+inline std::shared_ptr<const std::string> unparsed_section(ae::simdjson::Parser& parser, simdjson::ondemand::value source)
+{
+    const std::string_view token = source.raw_json_token();
+    if (token.empty() || (token[0] != '{' && token[0] != '['))
+        return nullptr;
+    const auto json_end = parser.source().data() + parser.source().size();
+    const auto* last = end_of_json_object_or_array(token.data(), json_end);
+    auto json = std::make_shared<std::string>();
+    json->reserve(static_cast<size_t>(last - token.data()) + simdjson::SIMDJSON_PADDING);
+    json->assign(token.data(), last);
+    return json;
+}
+
+// ----------------------------------------------------------------------
+
+void ae::chart::v3::Chart::read(ae::simdjson::Parser& parser, chart_import import)
 {
     using namespace ae::simdjson;
 
+    // returns if section was left unparsed
+    const auto defer = [this, &parser, import](section sec, simdjson::ondemand::value value) {
+        if (import == chart_import::lazy) {
+            if (auto json = unparsed_section(parser, value); json) {
+                unparsed_[static_cast<size_t>(sec)] = std::move(json);
+                return true;
+            }
+        }
+        return false;
+    };
+
     for (auto field : parser.doc().get_object()) {
         const std::string_view key = field.unescaped_key();
         // fmt::print(">>>> key \"{}\"\n", key);
@@ -867,16 +923,20 @@ void ae::chart::v3::Chart::read(ae::simdjson::Parser& parser)
                             read_sera(sera(), field_c.value().get_array());
                             break;
                         case 't':
-                            read_titers(titers(), field_c.value().get_object());
+                            if (!defer(section::titers, field_c.value()))
+                                read_titers(titers(), field_c.value().get_object());
                             break;
                         case 'P':
-                            read_projections(projections(), field_c.value().get_array());
+                            if (!defer(section::projections, field_c.value()))
+                                read_projections(projections(), field_c.value().get_array());
                             break;
                         case 'R':
-                            read_semantic_plot_specification(styles(), field_c.value().get_object());
+                            if (!defer(section::styles, field_c.value()))
+                                read_semantic_plot_specification(styles(), field_c.value().get_object());
                             break;
                         case 'p':
-                            read_legacy_plot_specification(legacy_plot_spec(), field_c.value().get_object());
+                            if (!defer(section::legacy_plot_spec, field_c.value()))
+                                read_legacy_plot_specification(legacy_plot_spec(), field_c.value().get_object());
                             break;
                         case 'C': // forced column bases for a new projections
                             for (const double cb : field_c.value().get_array())
@@ -913,14 +973,93 @@ void ae::chart::v3::Chart::read(ae::simdjson::Parser& parser)
 
 // ----------------------------------------------------------------------
 
-void ae::chart::v3::Chart::read(const std::filesystem::path& filename)
+void ae::chart::v3::Chart::parse_section(section sec) const
+{
+    using namespace ae::simdjson;
+
+    // section json is dropped only after successful parsing: if parsing fails, the partially read section is cleared and
+    // the error is reported again on every access
+    auto& json = unparsed_[static_cast<size_t>(sec)];
+    try {
+        Parser parser{json};
+        try {
+            switch (sec) {
+                case section::titers:
+                    read_titers(titers_, parser.doc().get_object());
+                    break;
+                case section::projections:
+                    read_projections(projections_, parser.doc().get_array());
+                    break;
+                case section::styles:
+                    read_semantic_plot_specification(styles_, parser.doc().get_object());
+                    break;
+                case section::legacy_plot_spec:
+                    read_legacy_plot_specification(legacy_plot_spec_, parser.doc().get_object());
+                    break;
+            }
+        }
+        catch (simdjson_error& err) {
+            throw Error{"parsing error (lazy import): {} at {} \"{}\"\n", err.what(), parser.current_location_offset(), parser.current_location_snippet(50)};
+        }
+    }
+    catch (simdjson_error& err) {
+        clear_section(sec);
+        throw Error{"json parser creation error (lazy import): {}\n", err.what()};
+    }
+    catch (std::exception&) {
+        clear_section(sec);
+        throw;
+    }
+    json.reset();
+
+} // ae::chart::v3::Chart::parse_section
+
+// ----------------------------------------------------------------------
+
+void ae::chart::v3::Chart::clear_section(section sec) const
+{
+    switch (sec) {
+        case section::titers:
+            titers_ = Titers{};
+            break;
+        case section::projections:
+            projections_ = Projections{};
+            break;
+        case section::styles:
+            styles_ = semantic::Styles{};
+            break;
+        case section::legacy_plot_spec:
+            legacy_plot_spec_ = legacy::PlotSpec{};
+            break;
+    }
+
+} // ae::chart::v3::Chart::clear_section
+
+// ----------------------------------------------------------------------
+
+void ae::chart::v3::Chart::parse_all_sections() const
+{
+    for (size_t sec_no = 0; sec_no < number_of_sections; ++sec_no) {
+        if (unparsed_[sec_no])
+            parse_section(static_cast<section>(sec_no));
+    }
+
+} // ae::chart::v3::Chart::parse_all_sections
+
+// ----------------------------------------------------------------------
+
+void ae::chart::v3::Chart::read(const std::filesystem::path& filename, chart_import import)
 {
     Timeit ti{fmt::format("importing chart from {}", filename), std::chrono::milliseconds{1000}};
     using namespace ae::simdjson;
     try {
+        if (binary::is_binary_file(filename)) {
+            read_binary(binary::view_t{filename});
+            return;
+        }
         Parser parser{filename};
         try {
-            read(parser);
+            read(parser, import);
         }
         catch (simdjson_error& err) {
             throw Error{"{} parsing error: {} at {} \"{}\"\n", filename.native(), err.what(), parser.current_location_offset(), parser.current_location_snippet(50)};
@@ -937,14 +1076,18 @@ void ae::chart::v3::Chart::read(const std::filesystem::path& filename)
 
 // ----------------------------------------------------------------------
 
-void ae::chart::v3::Chart::read(std::string_view data)
+void ae::chart::v3::Chart::read(std::string_view data, chart_import import)
 {
     Timeit ti{fmt::format("importing chart from {} bytes", data.size()), std::chrono::milliseconds{1000}};
+    if (binary::is_binary(data)) {
+        read_binary(binary::view_t{data});
+        return;
+    }
     using namespace ae::simdjson;
     try {
         Parser parser{data};
         try {
-            read(parser);
+            read(parser, import);
         }
         catch (simdjson_error& err) {
             throw Error{"parsing error: {} at {} \"{}\"\n", err.what(), parser.current_location_offset(), parser.current_location_snippet(50)};
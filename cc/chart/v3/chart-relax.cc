@@ -0,0 +1,195 @@
+#include <optional>
+#include <charconv>
+
+#include "utils/log.hh"
+#include "chart/v3/chart.hh"
+#include "chart/v3/relax-cache.hh"
+#include "chart/v3/relax-checkpoint.hh"
+
+// ----------------------------------------------------------------------
+
+namespace ae::chart::v3::relax
+{
+    constexpr const std::string_view usage{R"(Usage: chart-relax [options] <source-chart> [<output-chart>]
+
+Makes antigenic maps from random starting layouts, projections are sorted by stress.
+
+  -n <number>                  number of optimizations (default: 100)
+  -d <number>                  number of dimensions (default: 2)
+  -m <mcb>                     minimum column basis (default: none)
+  -k, --keep-projections <n>   number of projections to keep, 0 - keep all (default: 10)
+  --dimension-annealing        start in 5d and reduce to the target number of dimensions
+  --precision <p>              fine, rough, very-rough (default: fine)
+  --rough                      same as --precision rough
+  --method <method>            alglib-cg, alglib-lbfgs (default: alglib-cg)
+  --md <multiplier>            randomization diameter multiplier (default: 2.0)
+  --threads <number>           number of threads, 0 - autodetect (default: 0)
+  --seed <number>              seed for the starting layouts, results do not depend on --threads
+  --no-disconnect-having-few-titers
+  --remove-original-projections
+  --checkpoint <file>          write the best projections found so far and the state of the run
+                               to <file> (binary, not compressed), resume from it if it exists
+                               (the same source chart and options are required)
+  --checkpoint-every <number>  number of optimizations between checkpoints (default: 1000)
+  --relax-cache <dir>          reuse results of the same seeded relax stored in <dir>
+  --relax-cache-limit <MiB>    size limit of the relax cache (default: 1024)
+  --no-relax-cache             do not look up and store results in the relax cache
+
+If no output chart is given, a brief report is printed.
+)"};
+
+    struct options_t
+    {
+        std::filesystem::path source_chart{};
+        std::optional<std::filesystem::path> output_chart{};
+        relax_checkpoint::parameters_t parameters{};
+        bool remove_original_projections{false};
+        std::optional<std::filesystem::path> checkpoint{};
+        size_t checkpoint_every{1000};
+    };
+
+    class error : public std::runtime_error
+    {
+      public:
+        using std::runtime_error::runtime_error;
+    };
+
+    template <typename T> static T to_number(std::string_view option, std::string_view source)
+    {
+        T result{};
+        if (const auto [end, ec] = std::from_chars(source.data(), source.data() + source.size(), result); ec != std::errc{} || end != source.data() + source.size())
+            throw error{fmt::format("invalid value for {}: \"{}\"", option, source)};
+        return result;
+    }
+
+    static options_t parse_command_line(int argc, const char* const argv[]);
+    static void report(const Chart& chart);
+
+} // namespace ae::chart::v3::relax
+
+// ----------------------------------------------------------------------
+
+int main(int argc, const char* const argv[])
+{
+    using namespace ae::chart::v3;
+    int exit_code = 0;
+    try {
+        const auto opt = relax::parse_command_line(argc, argv);
+
+        Chart chart{opt.source_chart};
+        if (opt.remove_original_projections)
+            chart.projections().remove_all();
+        relax_checkpoint::relax(chart, opt.parameters, opt.checkpoint, opt.checkpoint_every, [&chart, &opt](size_t completed) {
+            fmt::print(stderr, "> {} of {} optimizations completed, best stress: {:.6f}\n", completed, opt.parameters.number_of_optimizations, chart.projections().best().stress());
+        });
+
+        if (opt.output_chart)
+            chart.write(*opt.output_chart);
+        else
+            relax::report(chart);
+        if (opt.checkpoint)
+            std::filesystem::remove(*opt.checkpoint);
+    }
+    catch (relax::error& err) {
+        fmt::print(stderr, "> ERROR {}\n\n{}", err.what(), relax::usage);
+        exit_code = 1;
+    }
+    catch (std::exception& err) {
+        AD_ERROR("{}", err.what());
+        exit_code = 2;
+    }
+    return exit_code;
+}
+
+// ----------------------------------------------------------------------
+
+ae::chart::v3::relax::options_t ae::chart::v3::relax::parse_command_line(int argc, const char* const argv[])
+{
+    options_t opt;
+    std::vector<std::string_view> arguments;
+    for (int arg_no = 1; arg_no < argc; ++arg_no) {
+        const std::string_view arg{argv[arg_no]};
+        const auto value = [&arg_no, argc, argv, arg]() -> std::string_view {
+            if (++arg_no >= argc)
+                throw error{fmt::format("{} requires an argument", arg)};
+            return argv[arg_no];
+        };
+
+        if (arg == "-h" || arg == "--help") {
+            fmt::print("{}", usage);
+            std::exit(0);
+        }
+        else if (arg == "-n")
+            opt.parameters.number_of_optimizations = to_number<size_t>(arg, value());
+        else if (arg == "-d")
+            opt.parameters.number_of_dimensions = ae::number_of_dimensions_t{to_number<size_t>(arg, value())};
+        else if (arg == "-m")
+            opt.parameters.minimum_column_basis = value();
+        else if (arg == "-k" || arg == "--keep-projections")
+            opt.parameters.keep_projections = to_number<size_t>(arg, value());
+        else if (arg == "--dimension-annealing")
+            opt.parameters.optimization.dimension_annealing = use_dimension_annealing::yes;
+        else if (arg == "--precision") {
+            if (const auto precision = value(); precision == "fine")
+                opt.parameters.optimization.precision = optimization_precision::fine;
+            else if (precision == "rough")
+                opt.parameters.optimization.precision = optimization_precision::rough;
+            else if (precision == "very-rough")
+                opt.parameters.optimization.precision = optimization_precision::very_rough;
+            else
+                throw error{fmt::format("invalid precision: \"{}\"", precision)};
+        }
+        else if (arg == "--rough")
+            opt.parameters.optimization.precision = optimization_precision::rough;
+        else if (arg == "--method")
+            opt.parameters.optimization.method = optimization_method_from_string(value());
+        else if (arg == "--md")
+            opt.parameters.optimization.randomization_diameter_multiplier = to_number<double>(arg, value());
+        else if (arg == "--threads")
+            opt.parameters.optimization.num_threads = to_number<int>(arg, value());
+        else if (arg == "--seed")
+            opt.parameters.optimization.seed = to_number<std::uint_fast32_t>(arg, value());
+        else if (arg == "--no-disconnect-having-few-titers")
+            opt.parameters.optimization.disconnect_too_few_numeric_titers = disconnect_few_numeric_titers::no;
+        else if (arg == "--remove-original-projections")
+            opt.remove_original_projections = true;
+        else if (arg == "--checkpoint")
+            opt.checkpoint = value();
+        else if (arg == "--checkpoint-every")
+            opt.checkpoint_every = to_number<size_t>(arg, value());
+        else if (arg == "--relax-cache")
+            relax_cache::settings(relax_cache::settings_t{.directory = value(), .size_limit = relax_cache::settings().size_limit});
+        else if (arg == "--relax-cache-limit")
+            relax_cache::settings(relax_cache::settings_t{.directory = relax_cache::settings().directory, .size_limit = to_number<size_t>(arg, value()) << 20});
+        else if (arg == "--no-relax-cache")
+            opt.parameters.optimization.cache = use_relax_cache::no;
+        else if (arg.size() > 1 && arg[0] == '-')
+            throw error{fmt::format("unrecognized option: {}", arg)};
+        else
+            arguments.push_back(arg);
+    }
+
+    if (arguments.empty() || arguments.size() > 2)
+        throw error{"source chart (and optionally output chart) expected"};
+    opt.source_chart = arguments[0];
+    if (arguments.size() > 1)
+        opt.output_chart = arguments[1];
+    if (opt.parameters.number_of_optimizations == 0)
+        throw error{"invalid number of optimizations: 0"};
+    return opt;
+
+} // ae::chart::v3::relax::parse_command_line
+
+// ----------------------------------------------------------------------
+
+void ae::chart::v3::relax::report(const Chart& chart)
+{
+    fmt::print("{} {}:{} projections: {}\n", chart.name(), chart.antigens().size(), chart.sera().size(), chart.projections().size());
+    for (const auto p_no : chart.projections().size()) {
+        const auto& projection = chart.projections()[p_no];
+        fmt::print("{:3d} {:11.6f} {}d >={}\n", p_no, projection.stress(), projection.number_of_dimensions(), projection.minimum_column_basis());
+    }
+
+} // ae::chart::v3::relax::report
+
+// ----------------------------------------------------------------------
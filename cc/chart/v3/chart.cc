@@ -3,6 +3,8 @@
 #include "chart/v3/stress.hh"
 #include "chart/v3/randomizer.hh"
 #include "chart/v3/optimize.hh"
+#include "chart/v3/relax-cache.hh"
+#include "chart/v3/attribute-index.hh"
 
 #include "chart/v3/disconnected-points-handler.hh"
 #include "chart/v3/selected-antigens-sera.hh"
@@ -48,15 +50,39 @@ std::string ae::chart::v3::Chart::name_for_file() const
 
 // ----------------------------------------------------------------------
 
+template <typename AgSr> const ae::chart::v3::attribute_index_t<AgSr>& ae::chart::v3::Chart::attributes() const
+{
+    auto& cache = [this]() -> auto& {
+        if constexpr (std::is_same_v<AgSr, Antigens>)
+            return antigen_attributes_;
+        else
+            return serum_attributes_;
+    }();
+    const auto& ag_sr = antigens_sera<AgSr>();
+    const std::lock_guard lock{cache.mutex};
+    if (!cache.index || cache.modifications != ag_sr.modifications()) {
+        cache.index = std::make_shared<const attribute_index_t<AgSr>>(ag_sr);
+        cache.modifications = ag_sr.modifications();
+    }
+    return *cache.index;
+
+} // ae::chart::v3::Chart::attributes
+
+template const ae::chart::v3::attribute_index_t<ae::chart::v3::Antigens>& ae::chart::v3::Chart::attributes<ae::chart::v3::Antigens>() const;
+template const ae::chart::v3::attribute_index_t<ae::chart::v3::Sera>& ae::chart::v3::Chart::attributes<ae::chart::v3::Sera>() const;
+
+// ----------------------------------------------------------------------
+
 ae::chart::v3::column_bases ae::chart::v3::Chart::column_bases(minimum_column_basis mcb) const
 {
     // forced column bases are stored with the sera
+    const auto raw = titers().raw_column_bases();
     class column_bases cb;
     for (const auto sr_no : sera().size()) {
         if (const auto fcb = sera()[sr_no].forced_column_basis(); fcb.has_value())
             cb.add(mcb.apply(*fcb));
         else
-            cb.add(mcb.apply(titers().raw_column_basis(sr_no)));
+            cb.add(mcb.apply(raw[sr_no]));
     }
     return cb;
 
@@ -104,7 +130,11 @@ void ae::chart::v3::Chart::relax(number_of_optimizations_t number_of_optimizatio
     if (const auto num_connected = antigens().size().get() + sera().size().get() - stress.number_of_disconnected(); num_connected < 3)
         throw std::runtime_error{AD_FORMAT("cannot relax: too few connected points: {}", num_connected)};
     // report_disconnected_unmovable(stress.parameters().disconnected, stress.parameters().unmovable);
-    auto rnd = randomizer_plain_from_sample_optimization(*this, stress, start_num_dim, mcb, options.randomization_diameter_multiplier);
+    const auto cache_key = relax_cache::key(*this, number_of_optimizations, mcb, number_of_dimensions, options, stress.parameters());
+    if (cache_key.has_value() && relax_cache::load(*cache_key, *this, number_of_optimizations, mcb, stress.parameters()))
+        return;
+
+    auto rnd = randomizer_plain_from_sample_optimization(*this, stress, start_num_dim, mcb, options.randomization_diameter_multiplier, options.seed);
 
     const auto first = projections().size();
     for ([[maybe_unused]] const auto opt_no : number_of_optimizations) {
@@ -120,7 +150,7 @@ void ae::chart::v3::Chart::relax(number_of_optimizations_t number_of_optimizatio
 #pragma omp parallel for default(shared) num_threads(num_threads) firstprivate(stress) schedule(static, slot_size)
     for (size_t p_no = *first; p_no < *projections().size(); ++p_no) {
         auto& projection = projections()[projection_index{p_no}];
-        projection.randomize_layout(*rnd);
+        projection.randomize_layout(*rnd->stream(options.first_optimization + p_no - *first)); // independent of thread count and scheduling
         auto& layout = projection.layout();
         stress.change_number_of_dimensions(start_num_dim);
         const auto status1 =
@@ -145,6 +175,9 @@ void ae::chart::v3::Chart::relax(number_of_optimizations_t number_of_optimizatio
         // AD_DEBUG("{:3d} {:.4f}", p_no, projection.stress());
     }
 
+    if (cache_key.has_value())
+        relax_cache::store(*cache_key, *this, first);
+
 } // ae::chart::v3::Chart::relax
 
 // ----------------------------------------------------------------------
@@ -171,7 +204,7 @@ void ae::chart::v3::Chart::relax_incremental(projection_index source_projection_
         throw std::runtime_error{AD_FORMAT("cannot relax: too few connected points: {}", num_connected)};
     // report_disconnected_unmovable(stress.parameters().disconnected, stress.parameters().unmovable);
 
-    auto rnd = randomizer_plain_from_sample_optimization(*this, stress, num_dim, mcb, options.randomization_diameter_multiplier);
+    auto rnd = randomizer_plain_from_sample_optimization(*this, stress, num_dim, mcb, options.randomization_diameter_multiplier, options.seed);
 
     point_indexes points_with_nan_coordinates;
     for (const auto p_no : src().layout().number_of_points()) {
@@ -193,7 +226,7 @@ void ae::chart::v3::Chart::relax_incremental(projection_index source_projection_
 #pragma omp parallel for default(shared) num_threads(num_threads) firstprivate(stress) schedule(static, slot_size)
     for (size_t p_no = *first; p_no < *projections().size(); ++p_no) {
         auto& projection = projections()[projection_index{p_no}];
-        projection.randomize_layout(points_with_nan_coordinates, *rnd);
+        projection.randomize_layout(points_with_nan_coordinates, *rnd->stream(options.first_optimization + p_no - *first));
         auto& layout = projection.layout();
         const auto status = optimize(options.method, stress, layout.span(), optimization_precision::rough);
         if (!std::isnan(status.final_stress))
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <array>
+#include <mutex>
 #include <unordered_map>
 
 #include "ext/filesystem.hh"
+#include "ext/compressor.hh"
 #include "sequences/lineage.hh"
 #include "chart/v3/info.hh"
 #include "chart/v3/antigens.hh"
@@ -19,10 +22,16 @@ namespace ae::simdjson
     class Parser;
 }
 
+namespace ae::chart::v3::binary
+{
+    class view_t;
+}
+
 namespace ae::chart::v3
 {
     struct SelectedAntigens;
     struct SelectedSera;
+    template <typename AgSr> class attribute_index_t;
 
     class Error : public std::runtime_error
     {
@@ -33,12 +42,57 @@ namespace ae::chart::v3
 
     // ----------------------------------------------------------------------
 
+    // attribute index built on demand by Chart::attributes() and the
+    // AntigensSera::modifications() it was built for, copying does not
+    // copy the mutex
+    template <typename AgSr> struct attribute_index_cache_t
+    {
+        attribute_index_cache_t() = default;
+        attribute_index_cache_t(const attribute_index_cache_t& src)
+        {
+            const std::lock_guard lock{src.mutex};
+            index = src.index;
+            modifications = src.modifications;
+        }
+        attribute_index_cache_t& operator=(const attribute_index_cache_t& src)
+        {
+            if (this != &src) {
+                const std::scoped_lock lock{mutex, src.mutex};
+                index = src.index;
+                modifications = src.modifications;
+            }
+            return *this;
+        }
+
+        void reset()
+        {
+            const std::lock_guard lock{mutex};
+            index.reset();
+        }
+
+        mutable std::mutex mutex{};
+        std::shared_ptr<const attribute_index_t<AgSr>> index{};
+        size_t modifications{0};
+    };
+
+    // ----------------------------------------------------------------------
+
+    // lazy: titers, projections, semantic styles and legacy plot spec
+    // are kept as json during import and parsed on the first access,
+    // e.g. listing antigens of a big chart does not parse its titer
+    // layers and projections
+    enum class chart_import { complete, lazy };
+
+    // significant digits of layout coordinates in the exported json,
+    // round_trip: shortest form that is imported back into the same value
+    enum class layout_precision : int { round_trip = 0 };
+
     class Chart
     {
       public:
         Chart() = default;
-        Chart(const std::filesystem::path& filename) { read(filename); }
-        Chart(std::string_view data) { read(data); }
+        Chart(const std::filesystem::path& filename, chart_import import = chart_import::complete) { read(filename, import); }
+        Chart(std::string_view data, chart_import import = chart_import::complete) { read(data, import); }
 
         Chart(const Chart&) = default;
         Chart(Chart&&) = default;
@@ -53,24 +107,47 @@ namespace ae::chart::v3
         Sera& sera() { return sera_; }
         const Sera& sera() const { return sera_; }
         template <typename AgSr> AgSr& antigens_sera()
+        {
+            if constexpr (std::is_same_v<AgSr, Antigens>)
+                return antigens();
+            else
+                return sera();
+        }
+        template <typename AgSr> const AgSr& antigens_sera() const
         {
             if constexpr (std::is_same_v<AgSr, Antigens>)
                 return antigens_;
             else
                 return sera_;
         }
-        Titers& titers() { return titers_; }
-        const Titers& titers() const { return titers_; }
-        Projections& projections() { return projections_; }
-        const Projections& projections() const { return projections_; }
-        semantic::Styles& styles() { return styles_; }
-        const semantic::Styles& styles() const { return styles_; }
-        legacy::PlotSpec& legacy_plot_spec() { return legacy_plot_spec_; }
-        const legacy::PlotSpec& legacy_plot_spec() const { return legacy_plot_spec_; }
+
+        // index of antigen/serum attributes for selections, built on
+        // demand and rebuilt if antigens/sera were modified since (see
+        // AntigensSera::modifications()), the reference is valid until
+        // the next modification; building is thread safe
+        template <typename AgSr> const attribute_index_t<AgSr>& attributes() const;
+        void drop_attribute_index()
+        {
+            antigen_attributes_.reset();
+            serum_attributes_.reset();
+        }
+        Titers& titers() { return parsed(section::titers, titers_); }
+        const Titers& titers() const { return parsed(section::titers, titers_); }
+        Projections& projections() { return parsed(section::projections, projections_); }
+        const Projections& projections() const { return parsed(section::projections, projections_); }
+        semantic::Styles& styles() { return parsed(section::styles, styles_); }
+        const semantic::Styles& styles() const { return parsed(section::styles, styles_); }
+        legacy::PlotSpec& legacy_plot_spec() { return parsed(section::legacy_plot_spec, legacy_plot_spec_); }
+        const legacy::PlotSpec& legacy_plot_spec() const { return parsed(section::legacy_plot_spec, legacy_plot_spec_); }
+        // parses sections left unparsed by the lazy import, parsing on
+        // access is not thread safe, call it before sharing the chart
+        // between threads
+        void parse_all_sections() const;
         // implement in kateri! void semantic_style_to_legacy(std::string_view style_name) { styles().find_and_export_to(style_name, legacy_plot_spec()); }
 
-        std::string export_to_json() const;
-        void write(const std::filesystem::path& filename) const;
+        std::string export_to_json(layout_precision precision = layout_precision::round_trip) const;
+        std::string export_to_binary() const; // see chart/v3/chart-binary.hh
+        void write(const std::filesystem::path& filename, layout_precision precision = layout_precision::round_trip) const; // .acb: binary, otherwise compressed json
 
         std::string name(std::optional<projection_index> aProjectionNo = std::nullopt) const;
         std::string name_for_file() const;
@@ -99,17 +176,38 @@ namespace ae::chart::v3
         void remove_sera(const SelectedSera& to_remove);
 
       private:
+        enum class section : size_t { titers, projections, styles, legacy_plot_spec };
+        static constexpr size_t number_of_sections{4};
+
         Info info_{};
         Antigens antigens_{};
         Sera sera_{};
-        Titers titers_{};
-        Projections projections_{};
-        semantic::Styles styles_{};
-        legacy::PlotSpec legacy_plot_spec_{};
-
-        void read(const std::filesystem::path& filename);
-        void read(std::string_view data);
-        void read(ae::simdjson::Parser& parser);
+        // sections below are mutable to be parsed on const access after lazy import
+        mutable Titers titers_{};
+        mutable Projections projections_{};
+        mutable semantic::Styles styles_{};
+        mutable legacy::PlotSpec legacy_plot_spec_{};
+        mutable std::array<std::shared_ptr<const std::string>, number_of_sections> unparsed_{}; // json of the sections not parsed yet (padded for simdjson), shared by copies
+        mutable attribute_index_cache_t<Antigens> antigen_attributes_{};
+        mutable attribute_index_cache_t<Sera> serum_attributes_{};
+
+        void read(const std::filesystem::path& filename, chart_import import);
+        void read(std::string_view data, chart_import import);
+        void read(ae::simdjson::Parser& parser, chart_import import);
+        void parse_section(section sec) const;
+        void clear_section(section sec) const; // after parsing failure
+        void read_binary(const binary::view_t& view);
+
+        enum class export_bulk_data { no, yes }; // no: titers and layouts are omitted (stored in the binary sections)
+        std::string export_to_json(export_bulk_data bulk_data) const;
+        void export_to_json(export_bulk_data bulk_data, const ae::file::chunk_sink_t& sink, layout_precision precision = layout_precision::round_trip) const; // output in chunks, memory use does not depend on the chart size
+
+        template <typename Target> Target& parsed(section sec, Target& target) const
+        {
+            if (unparsed_[static_cast<size_t>(sec)])
+                parse_section(sec);
+            return target;
+        }
     };
 
 } // namespace ae::chart::v3
@@ -14,6 +14,15 @@ ae::chart::v3::common_antigens_sera_t::common_antigens_sera_t(const Chart& prima
 
 // ----------------------------------------------------------------------
 
+ae::chart::v3::common_antigens_sera_t::common_antigens_sera_t(const Chart& primary, const Chart& secondary, antigens_sera_match_level_t match_level,
+                                                              const common_data_t<Antigens>::primary_index_t& primary_antigens_index, const common_data_t<Sera>::primary_index_t& primary_sera_index)
+    : antigens_{primary.antigens(), secondary.antigens(), match_level, primary_antigens_index}, sera_{primary.sera(), secondary.sera(), match_level, primary_sera_index}
+{
+
+} // ae::chart::v3::common_antigens_sera_t::common_antigens_sera_t
+
+// ----------------------------------------------------------------------
+
 ae::chart::v3::common_antigens_sera_t::common_antigens_sera_t(const Chart& primary)
     : antigens_{primary.antigens()}, sera_{primary.sera()}
 {
@@ -38,15 +47,41 @@ std::vector<ae::chart::v3::common_antigens_sera_t::common_t> ae::chart::v3::comm
 // ----------------------------------------------------------------------
 
 template <typename AgSrs> ae::chart::v3::common_data_t<AgSrs>::common_data_t(const AgSrs& primary, const AgSrs& secondary, antigens_sera_match_level_t match_level)
+    : common_data_t(primary, secondary, match_level, make_primary_index(primary))
+{
+}
+
+template ae::chart::v3::common_data_t<ae::chart::v3::Antigens>::common_data_t(const Antigens& primary, const Antigens& secondary, antigens_sera_match_level_t match_level);
+template ae::chart::v3::common_data_t<ae::chart::v3::Sera>::common_data_t(const Sera& primary, const Sera& secondary, antigens_sera_match_level_t match_level);
+
+// ----------------------------------------------------------------------
+
+template <typename AgSrs>
+ae::chart::v3::common_data_t<AgSrs>::common_data_t(const AgSrs& primary, const AgSrs& secondary, antigens_sera_match_level_t match_level, const primary_index_t& primary_index)
     : primary_{primary}, secondary_{secondary}, min_number_{std::min(primary.size(), secondary.size())}
 {
-    build_match(match_level);
+    build_match(match_level, primary_index);
     sort_match();
     mark_match_use(match_level);
 }
 
-template ae::chart::v3::common_data_t<ae::chart::v3::Antigens>::common_data_t(const Antigens& primary, const Antigens& secondary, antigens_sera_match_level_t match_level);
-template ae::chart::v3::common_data_t<ae::chart::v3::Sera>::common_data_t(const Sera& primary, const Sera& secondary, antigens_sera_match_level_t match_level);
+template ae::chart::v3::common_data_t<ae::chart::v3::Antigens>::common_data_t(const Antigens& primary, const Antigens& secondary, antigens_sera_match_level_t match_level, const primary_index_t& primary_index);
+template ae::chart::v3::common_data_t<ae::chart::v3::Sera>::common_data_t(const Sera& primary, const Sera& secondary, antigens_sera_match_level_t match_level, const primary_index_t& primary_index);
+
+// ----------------------------------------------------------------------
+
+template <typename AgSrs> typename ae::chart::v3::common_data_t<AgSrs>::primary_index_t ae::chart::v3::common_data_t<AgSrs>::make_primary_index(const AgSrs& primary)
+{
+    primary_index_t primary_index;
+    primary_index.reserve(*primary.size());
+    for (const auto primary_no : primary.size())
+        add_to_primary_index(primary_index, primary[primary_no], primary_no);
+    return primary_index;
+
+} // ae::chart::v3::common_data_t<AgSrs>::make_primary_index
+
+template ae::chart::v3::common_data_t<ae::chart::v3::Antigens>::primary_index_t ae::chart::v3::common_data_t<ae::chart::v3::Antigens>::make_primary_index(const Antigens& primary);
+template ae::chart::v3::common_data_t<ae::chart::v3::Sera>::primary_index_t ae::chart::v3::common_data_t<ae::chart::v3::Sera>::make_primary_index(const Sera& primary);
 
 // ----------------------------------------------------------------------
 
@@ -95,34 +130,28 @@ template ae::serum_indexes ae::chart::v3::common_data_t<ae::chart::v3::Sera>::pr
 
 // ----------------------------------------------------------------------
 
-template <typename AgSrs> void ae::chart::v3::common_data_t<AgSrs>::build_match(antigens_sera_match_level_t match_level)
+template <typename AgSrs> void ae::chart::v3::common_data_t<AgSrs>::build_match(antigens_sera_match_level_t match_level, const primary_index_t& primary_index)
 {
-    auto primary_sorted{index_range(primary_.size())};
-    std::sort(primary_sorted.begin(), primary_sorted.end(), [this](auto i1, auto i2) { return compare_basic_designations(primary_[i1], primary_[i2]) == std::strong_ordering::less; });
-
-    const auto primary_secondary_less = [this](index_t primary_index, const typename AgSrs::element_t& seco) -> bool {
-        const auto& prim = primary_[primary_index];
-        return compare_basic_designations(prim, seco) == std::strong_ordering::less;
-    };
-    const auto secondary_primary_less = [this](const typename AgSrs::element_t& seco, index_t primary_index) -> bool {
-        const auto& prim = primary_[primary_index];
-        return compare_basic_designations(seco, prim) == std::strong_ordering::less;
-    };
+    // candidates have the same basic designation (name, annotations,
+    // reassortant), look them up by the cached basic designation hash,
+    // hash collisions are filtered out by compare_basic_designations()
     for (const auto secondary_index : secondary_.size()) {
         const auto& seco = secondary_[secondary_index];
-        const auto first = std::lower_bound(primary_sorted.begin(), primary_sorted.end(), seco, primary_secondary_less);
-        const auto last = std::upper_bound(primary_sorted.begin(), primary_sorted.end(), seco, secondary_primary_less);
+        if (seco.annotations().distinct())
+            continue;
+        const auto [first, last] = primary_index.equal_range(seco.basic_designation_hash());
         for (auto p_e = first; p_e != last; ++p_e) {
-            if (const auto score = match(primary_[*p_e], seco, match_level); score != score_t::no_match) {
-                match_.push_back({.primary = *p_e, .secondary = secondary_index, .score = score});
+            if (const auto& prim = primary_[p_e->second]; compare_basic_designations(prim, seco) == std::strong_ordering::equal) {
+                if (const auto score = match(prim, seco, match_level); score != score_t::no_match)
+                    match_.push_back({.primary = p_e->second, .secondary = secondary_index, .score = score});
             }
         }
     }
 
 } // ae::chart::v3::common_data_t<AgSrs>::build_match
 
-template void ae::chart::v3::common_data_t<ae::chart::v3::Antigens>::build_match(antigens_sera_match_level_t match_level);
-template void ae::chart::v3::common_data_t<ae::chart::v3::Sera>::build_match(antigens_sera_match_level_t match_level);
+template void ae::chart::v3::common_data_t<ae::chart::v3::Antigens>::build_match(antigens_sera_match_level_t match_level, const primary_index_t& primary_index);
+template void ae::chart::v3::common_data_t<ae::chart::v3::Sera>::build_match(antigens_sera_match_level_t match_level, const primary_index_t& primary_index);
 
 // ----------------------------------------------------------------------
 
@@ -202,22 +231,8 @@ template void ae::chart::v3::common_data_t<ae::chart::v3::Sera>::mark_match_use(
 template <typename AgSrs>
 typename ae::chart::v3::common_data_t<AgSrs>::score_t ae::chart::v3::common_data_t<AgSrs>::match(const AgSr& prim, const AgSr& seco, antigens_sera_match_level_t match_level) const
 {
-    // using namespace std::string_view_literals;
-    const auto match_report = [](bool equals, std::string_view report) -> std::string_view {
-        if (equals)
-            return {};
-        else
-            return report;
-    };
-
-    const auto name_neq = match_report(prim.name() == seco.name(), "name"),                      //
-        reassortant_neq = match_report(prim.reassortant() == seco.reassortant(), "reassortant"), //
-        annotations_neq = match_report(prim.annotations() == seco.annotations(), "annotations")  //,
-        // primary_distict = match_report(!prim.annotations().distinct(), "primary-distinct"),      //
-        // secondary_distict = match_report(!seco.annotations().distinct(), "secondary-distinct") //
-        ;
-
-    if (name_neq.empty() && reassortant_neq.empty() && annotations_neq.empty() && !prim.annotations().distinct() && !seco.annotations().distinct()) {
+    // name, reassortant and annotations are already compared by build_match() via basic designations
+    if (!prim.annotations().distinct() && !seco.annotations().distinct()) {
         // AD_LOG(acmacs::log::common, "{} \"{}\" == \"{}\"", primary.ag_sr(), primary.full_name(), secondary.full_name());
         switch (match_level) {
             case antigens_sera_match_level_t::ignored:
@@ -229,7 +244,6 @@ typename ae::chart::v3::common_data_t<AgSrs>::score_t ae::chart::v3::common_data
         }
     }
 
-    // AD_DEBUG("{} \"{}\" != \"{}\": {} {} {}", prim.ag_sr, prim.designation(), seco.designation(), name_neq, reassortant_neq, annotations_neq);
     return score_t::no_match;
 }
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <unordered_map>
+
 #include "chart/v3/antigens.hh"
 
 // ----------------------------------------------------------------------
@@ -17,10 +19,22 @@ namespace ae::chart::v3
         using common_t = std::pair<index_t, index_t>;
         enum class score_t : size_t { no_match = 0, passage_serum_id_ignored = 1, egg = 2, without_date = 3, full_match = 4 };
 
+        // basic designation hash -> primary antigen/serum, distinct ones are not included
+        using primary_index_t = std::unordered_multimap<uint64_t, index_t>;
+
         common_data_t(common_data_t&&) = default;
         common_data_t(const AgSrs& primary, const AgSrs& secondary, antigens_sera_match_level_t match_level);
+        // primary_index is kept by the caller for primary antigens/sera growing between matchings (merge of many charts)
+        common_data_t(const AgSrs& primary, const AgSrs& secondary, antigens_sera_match_level_t match_level, const primary_index_t& primary_index);
         common_data_t(const AgSrs& primary);
 
+        static void add_to_primary_index(primary_index_t& primary_index, const AgSr& ag_sr, index_t no)
+        {
+            if (!ag_sr.annotations().distinct())
+                primary_index.emplace(ag_sr.basic_designation_hash(), no);
+        }
+        static primary_index_t make_primary_index(const AgSrs& primary);
+
         std::vector<common_t> common() const;
         indexes_t primary() const;
         std::string report(size_t indent) const;
@@ -55,9 +69,9 @@ namespace ae::chart::v3
         size_t number_of_common_{0};
         const index_t min_number_;
 
-        score_t match(const AgSr& prim, const AgSr& seco, antigens_sera_match_level_t match_level) const;
+        score_t match(const AgSr& prim, const AgSr& seco, antigens_sera_match_level_t match_level) const; // prim and seco have the same basic designation
         score_t match_not_ignored(const AgSr& prim, const AgSr& seco) const;
-        void build_match(antigens_sera_match_level_t match_level);
+        void build_match(antigens_sera_match_level_t match_level, const primary_index_t& primary_index);
         void sort_match();
         void mark_match_use(antigens_sera_match_level_t match_level);
         size_t primary_name_max_size() const;
@@ -75,6 +89,10 @@ namespace ae::chart::v3
 
     extern template common_data_t<Antigens>::common_data_t(const Antigens& primary, const Antigens& secondary, antigens_sera_match_level_t match_level);
     extern template common_data_t<Sera>::common_data_t(const Sera& primary, const Sera& secondary, antigens_sera_match_level_t match_level);
+    extern template common_data_t<Antigens>::common_data_t(const Antigens& primary, const Antigens& secondary, antigens_sera_match_level_t match_level, const primary_index_t& primary_index);
+    extern template common_data_t<Sera>::common_data_t(const Sera& primary, const Sera& secondary, antigens_sera_match_level_t match_level, const primary_index_t& primary_index);
+    extern template common_data_t<Antigens>::primary_index_t common_data_t<Antigens>::make_primary_index(const Antigens& primary);
+    extern template common_data_t<Sera>::primary_index_t common_data_t<Sera>::make_primary_index(const Sera& primary);
     extern template common_data_t<Antigens>::common_data_t(const Antigens& primary);
     extern template common_data_t<Sera>::common_data_t(const Sera& primary);
 
@@ -107,6 +125,8 @@ namespace ae::chart::v3
 
         common_antigens_sera_t(common_antigens_sera_t&&) = default;
         common_antigens_sera_t(const Chart& primary, const Chart& secondary, antigens_sera_match_level_t match_level);
+        common_antigens_sera_t(const Chart& primary, const Chart& secondary, antigens_sera_match_level_t match_level, const common_data_t<Antigens>::primary_index_t& primary_antigens_index,
+                               const common_data_t<Sera>::primary_index_t& primary_sera_index);
         common_antigens_sera_t(const Chart& primary); // procrustes between projections of the same chart
 
         bool empty() const { return antigens_.empty() && sera_.empty(); }
@@ -1,3 +1,6 @@
+#include <numeric>
+
+#include "ext/hash.hh"
 #include "chart/v3/merge.hh"
 #include "chart/v3/chart.hh"
 #include "chart/v3/procrustes.hh"
@@ -6,7 +9,11 @@
 
 namespace ae::chart::v3
 {
+    static antigen_indexes secondary_antigens_to_merge(const Chart& chart1, const Chart& chart2, const common_antigens_sera_t& common, const merge_settings_t& settings);
     static void merge_info(Chart& merge, const Chart& chart1, const Chart& chart2);
+    static void merge_info_sources(Chart& merge, const Chart& source);
+    static void merge_info_derived(Chart& merge);
+    static void append_layers(Titers& merge_titers, const Titers& source, const std::vector<antigen_index>& antigen_target, const std::vector<serum_index>& serum_target, antigen_index number_of_antigens);
     static Titers::titer_merge_report merge_titers(Chart& merge, const Chart& chart1, const Chart& chart2, const merge_data_t& merge_data);
     static void merge_projections(Chart& merge, const Chart& chart1, const Chart& chart2, projection_merge_t projection_merge, const merge_data_t& merge_data);
     static void merge_projections_type2(Chart& merge, const Chart& chart1, const Chart& chart2, const merge_data_t& merge_data);
@@ -22,6 +29,38 @@ namespace ae::chart::v3
     static disconnected_points map_disconnected(const disconnected_points& source, antigen_index source_number_of_antigens, antigen_index target_number_of_antigens, const merge_data_t::index_mapping_t<antigen_index>& antigen_mapping, const merge_data_t::index_mapping_t<serum_index>& sera_mapping);
     static void merge_legacy_plot_spec(Chart& merge, const Chart& chart1, const Chart& chart2, const merge_data_t& merge_data);
 
+    // encoded titers of the antigens x sera subgrid in row-major order
+    using subgrid_titers_t = std::vector<uint32_t>;
+
+    static uint64_t fingerprint(const subgrid_titers_t& subgrid)
+    {
+        return xxhash::xxhash64(std::string_view{reinterpret_cast<const char*>(subgrid.data()), subgrid.size() * sizeof(subgrid_titers_t::value_type)});
+    }
+
+    static subgrid_titers_t subgrid_titers(const Titers& titers, const antigen_indexes& antigens, const serum_indexes& sera)
+    {
+        subgrid_titers_t subgrid;
+        subgrid.reserve(antigens.size() * sera.size());
+        for (const auto ag_no : antigens) {
+            for (const auto sr_no : sera)
+                subgrid.push_back(titers.titer(ag_no, sr_no).encoded());
+        }
+        return subgrid;
+    }
+
+    // scans each layer row once instead of looking up every cell
+    static subgrid_titers_t subgrid_titers(const Titers::sparse_t& layer, const antigen_indexes& antigens, const std::vector<size_t>& serum_column, size_t number_of_columns)
+    {
+        subgrid_titers_t subgrid(antigens.size() * number_of_columns, Titer{}.encoded());
+        for (size_t row_no = 0; row_no < antigens.size(); ++row_no) {
+            for (const auto [sr_no, titer] : layer[*antigens[row_no]]) {
+                if (const auto column = serum_column[*sr_no]; column < number_of_columns)
+                    subgrid[row_no * number_of_columns + column] = titer.encoded();
+            }
+        }
+        return subgrid;
+    }
+
     template <typename AgSrs> static void merge_antigens_sera(AgSrs& merge, const AgSrs& source, const merge_data_t::index_mapping_t<typename AgSrs::index_t>& to_target, bool always_replace)
     {
         for (const auto no : source.size()) {
@@ -76,6 +115,160 @@ std::pair<std::shared_ptr<ae::chart::v3::Chart>, ae::chart::v3::merge_data_t> ae
 
 // ----------------------------------------------------------------------
 
+std::pair<std::shared_ptr<ae::chart::v3::Chart>, ae::chart::v3::merge_report_t> ae::chart::v3::merge(const std::vector<std::shared_ptr<Chart>>& charts, const merge_settings_t& settings)
+{
+    try {
+        if (charts.size() < 2)
+            throw merge_error{"at least two charts required"};
+
+        // the first chart: antigens and sera are not reordered, layers are copied
+        auto merged = std::make_shared<Chart>();
+        {
+            const auto& chart1 = *charts.front();
+            chart1.throw_if_duplicates();
+            if (!chart1.styles().empty())
+                AD_WARNING("ae::chart::v3::merge: merging semantic styles not implemented");
+            merged->info().virus(chart1.info().virus());
+            merge_info_sources(*merged, chart1);
+            merged->antigens() = chart1.antigens();
+            merged->sera() = chart1.sera();
+            std::vector<antigen_index> antigen_target(*chart1.antigens().size());
+            std::iota(antigen_target.begin(), antigen_target.end(), antigen_index{0});
+            std::vector<serum_index> serum_target(*chart1.sera().size());
+            std::iota(serum_target.begin(), serum_target.end(), serum_index{0});
+            append_layers(merged->titers(), chart1.titers(), antigen_target, serum_target, merged->antigens().size());
+        }
+
+        cumulative_merge_t cumulative{merged, settings};
+        for (auto chart2 = std::next(charts.begin()); chart2 != charts.end(); ++chart2)
+            cumulative.append(**chart2);
+        return {std::move(merged), cumulative.finish(cumulative_merge_t::merged_titers::rebuild)};
+    }
+    catch (merge_error&) {
+        throw;
+    }
+    catch (std::exception& err) {
+        throw merge_error{err.what()};
+    }
+
+} // ae::chart::v3::merge
+
+// ----------------------------------------------------------------------
+
+ae::chart::v3::cumulative_merge_t::cumulative_merge_t(std::shared_ptr<Chart> merged, const merge_settings_t& settings)
+    : merged_{merged}, settings_{settings}, antigens_index_{common_data_t<Antigens>::make_primary_index(merged->antigens())},
+      sera_index_{common_data_t<Sera>::make_primary_index(merged->sera())}, first_new_layer_{merged->titers().number_of_layers()}
+{
+    if (settings_.projection_merge != projection_merge_t::type1)
+        throw merge_error{"cumulative merge: only type1 (simple) projection merge supported"};
+    if (settings_.remove_distinct_ != remove_distinct::no)
+        throw merge_error{"cumulative merge: removing distinct antigens not supported"};
+
+    auto& titers = merged_->titers();
+    if (first_new_layer_ < layer_index{2}) {
+        // merged titers are not (yet) set from layers
+        first_new_layer_ = layer_index{0};
+        if (titers.number_of_layers() == layer_index{0}) {
+            titers.create_layers(layer_index{1}, merged_->antigens().size());
+            sparse_titers_builder_t layer{merged_->antigens().size()};
+            for (const auto titer_ref : titers.titers_existing())
+                layer.add(titer_ref.antigen, titer_ref.serum, titer_ref.titer);
+            titers.layer(layer_index{0}) = layer.build();
+        }
+    }
+    merged_->projections().remove_all(); // the same as for merge with projection_merge_t::type1
+
+} // ae::chart::v3::cumulative_merge_t::cumulative_merge_t
+
+// ----------------------------------------------------------------------
+
+void ae::chart::v3::cumulative_merge_t::append(const Chart& chart2)
+{
+    try {
+        chart2.throw_if_duplicates();
+        if (!chart2.styles().empty())
+            AD_WARNING("ae::chart::v3::merge: merging semantic styles not implemented");
+        merge_info_sources(*merged_, chart2);
+
+        auto& merged_antigens = merged_->antigens();
+        auto& merged_sera = merged_->sera();
+        auto& titers = merged_->titers();
+
+        const common_antigens_sera_t common{*merged_, chart2, settings_.match_level, antigens_index_, sera_index_};
+        common_report_ = common.report(0);
+        if (settings_.combine_cheating_assays_ == combine_cheating_assays::yes) {
+            for (auto& layer : titers.layers())
+                layer.add_antigens(merged_antigens.size());
+        }
+
+        // antigens and sera of the merged chart keep their indexes, new ones are appended, see merge_data_t::build()
+        std::vector<antigen_index> antigen_target(*chart2.antigens().size(), antigen_index{invalid_index});
+        for (const auto no2 : secondary_antigens_to_merge(*merged_, chart2, common, settings_)) {
+            if (const auto no1 = common.antigen_primary_by_secondary(no2); no1) {
+                merged_antigens[*no1].update_with(chart2.antigens()[no2]);
+                antigen_target[*no2] = *no1;
+            }
+            else {
+                antigen_target[*no2] = merged_antigens.size();
+                common_data_t<Antigens>::add_to_primary_index(antigens_index_, chart2.antigens()[no2], antigen_target[*no2]);
+                merged_antigens.add() = chart2.antigens()[no2];
+            }
+        }
+        std::vector<serum_index> serum_target(*chart2.sera().size(), serum_index{invalid_index});
+        for (const auto no2 : chart2.sera().size()) {
+            if (const auto no1 = common.serum_primary_by_secondary(no2); no1) {
+                merged_sera[*no1].update_with(chart2.sera()[no2]);
+                serum_target[*no2] = *no1;
+            }
+            else {
+                serum_target[*no2] = merged_sera.size();
+                common_data_t<Sera>::add_to_primary_index(sera_index_, chart2.sera()[no2], serum_target[*no2]);
+                merged_sera.add() = chart2.sera()[no2];
+            }
+        }
+
+        append_layers(titers, chart2.titers(), antigen_target, serum_target, merged_antigens.size());
+    }
+    catch (merge_error&) {
+        throw;
+    }
+    catch (std::exception& err) {
+        throw merge_error{err.what()};
+    }
+
+} // ae::chart::v3::cumulative_merge_t::append
+
+// ----------------------------------------------------------------------
+
+ae::chart::v3::merge_report_t ae::chart::v3::cumulative_merge_t::finish(merged_titers recompute)
+{
+    try {
+        merge_info_derived(*merged_);
+        merged_->throw_if_duplicates();
+        auto& titers = merged_->titers();
+        for (auto& layer : titers.layers())
+            layer.add_antigens(merged_->antigens().size());
+
+        merge_report_t report{.common = common_report_};
+        if (recompute == merged_titers::rebuild || first_new_layer_ == layer_index{0})
+            report.titers = titers.set_from_layers(*merged_);
+        else
+            report.titers = titers.update_from_layers(*merged_, first_new_layer_);
+        first_new_layer_ = titers.number_of_layers();
+        merged_->legacy_plot_spec().initialize(merged_->antigens().size(), merged_->reference(), merged_->sera().size());
+        return report;
+    }
+    catch (merge_error&) {
+        throw;
+    }
+    catch (std::exception& err) {
+        throw merge_error{err.what()};
+    }
+
+} // ae::chart::v3::cumulative_merge_t::finish
+
+// ----------------------------------------------------------------------
+
 void ae::chart::v3::merge_data_t::build(const merge_settings_t& settings)
 {
     // antigens
@@ -88,7 +281,7 @@ void ae::chart::v3::merge_data_t::build(const merge_settings_t& settings)
             }
         }
         auto src2 = chart2_->antigens();
-        const auto secondary_antigen_indexes = secondary_antigens_to_merge(settings);
+        const auto secondary_antigen_indexes = secondary_antigens_to_merge(*chart1_, *chart2_, common_, settings);
         for (const auto no2 : secondary_antigen_indexes) {
             if (settings.remove_distinct_ == remove_distinct::no || !src2[no2].annotations().distinct()) {
                 if (const auto no1 = common_.antigen_primary_by_secondary(no2); no1)
@@ -128,12 +321,11 @@ void ae::chart::v3::merge_data_t::build(const merge_settings_t& settings)
 
 // ----------------------------------------------------------------------
 
-ae::antigen_indexes ae::chart::v3::merge_data_t::secondary_antigens_to_merge(const merge_settings_t& settings) const
+ae::antigen_indexes ae::chart::v3::secondary_antigens_to_merge(const Chart& chart1, const Chart& chart2, const common_antigens_sera_t& common, const merge_settings_t& settings)
 {
-    auto indexes = index_range(chart2_->antigens().size());
     if (settings.combine_cheating_assays_ == combine_cheating_assays::yes) {
         // expected: primary chart is single or multi layered, secondary chart is single layered
-        const auto& secondary_titers = chart2_->titers();
+        const auto& secondary_titers = chart2.titers();
         if (secondary_titers.number_of_layers() > layer_index{1})
             AD_WARNING("[chart merge and combine_cheating_assays]: secondary chart is multilayered, result can be unexpected");
 
@@ -155,47 +347,43 @@ ae::antigen_indexes ae::chart::v3::merge_data_t::secondary_antigens_to_merge(con
             return result;
         };
 
-        const auto antigens2_indexes = chart2_->reference();
-        const auto sera2_indexes = index_range(chart2_->sera().size());
-        const auto antigen_indexes1 = primary_by_secondary(antigens2_indexes, [this](auto no2) { return common_.antigen_primary_by_secondary(no2); });
-        const auto serum_indexes1 = primary_by_secondary(sera2_indexes, [this](auto no2) { return common_.serum_primary_by_secondary(no2); });
+        const auto antigens2_indexes = chart2.reference();
+        const auto sera2_indexes = index_range(chart2.sera().size());
+        const auto antigen_indexes1 = primary_by_secondary(antigens2_indexes, [&common](auto no2) { return common.antigen_primary_by_secondary(no2); });
+        const auto serum_indexes1 = primary_by_secondary(sera2_indexes, [&common](auto no2) { return common.serum_primary_by_secondary(no2); });
         if (all_secondary_in_primary) {
-            // check titers
-            const auto are_titers_same = [&](auto&& primary_titer) -> bool {
-                for (const auto antigen_index_no : antigen_index{antigens2_indexes.size()}) {
-                    for (const auto serum_index_no : serum_index{sera2_indexes.size()}) {
-                        if (secondary_titers.titer(antigens2_indexes[*antigen_index_no], sera2_indexes[*serum_index_no]) !=
-                            primary_titer(antigen_indexes1[*antigen_index_no], serum_indexes1[*serum_index_no]))
-                            return false;
-                    }
-                }
-                return true;
-            };
+            // check titers: compare fingerprints of the reference antigens x sera subgrid, full comparison if fingerprints are equal
+            const auto secondary_subgrid = subgrid_titers(secondary_titers, antigens2_indexes, sera2_indexes);
+            const auto secondary_fingerprint = fingerprint(secondary_subgrid);
 
-            const auto& primary_titers = chart1_->titers();
+            const auto& primary_titers = chart1.titers();
             if (primary_titers.number_of_layers() == layer_index{0}) {
-                titers_same = are_titers_same([&primary_titers](antigen_index ag, serum_index sr) { return primary_titers.titer(ag, sr); });
+                const auto primary_subgrid = subgrid_titers(primary_titers, antigen_indexes1, serum_indexes1);
+                titers_same = fingerprint(primary_subgrid) == secondary_fingerprint && primary_subgrid == secondary_subgrid;
             }
             else {
-                titers_same = false;
                 // if in any of the layers titers are the same
-                for (const auto layer_no : primary_titers.number_of_layers()) {
-                    titers_same |= are_titers_same([&primary_titers, layer_no](antigen_index ag, serum_index sr) { return primary_titers.titer_of_layer(layer_no, ag, sr); });
-                    if (titers_same)
-                        break;
+                std::vector<size_t> serum_column(*chart1.sera().size(), serum_indexes1.size());
+                for (size_t column = 0; column < serum_indexes1.size(); ++column)
+                    serum_column[*serum_indexes1[column]] = column;
+                // one subgrid at a time, compared in full only if fingerprints are equal
+                titers_same = false;
+                for (auto layer_no = layer_index{0}; !titers_same && layer_no < primary_titers.number_of_layers(); ++layer_no) {
+                    const auto primary_subgrid = subgrid_titers(primary_titers.layer(layer_no), antigen_indexes1, serum_column, serum_indexes1.size());
+                    titers_same = fingerprint(primary_subgrid) == secondary_fingerprint && primary_subgrid == secondary_subgrid;
                 }
             }
         }
 
         if (all_secondary_in_primary && titers_same) {
-            if (chart2_->antigens().size() == antigen_index{antigens2_indexes.size()}) {
-                AD_ERROR("cheating assay ({}) and chart has no test antigens, remove table or disable cheating assay handling", chart2_->name());
+            if (chart2.antigens().size() == antigen_index{antigens2_indexes.size()}) {
+                AD_ERROR("cheating assay ({}) and chart has no test antigens, remove table or disable cheating assay handling", chart2.name());
                 throw merge_error{"cheating assay and chart has no test antigens"};
             }
-            auto test_indexes = index_range(chart2_->antigens().size());
+            auto test_indexes = index_range(chart2.antigens().size());
             for (const auto ind : antigens2_indexes)
                 test_indexes.remove(ind);
-            AD_INFO("cheating assay ({}) will be combined, no reference titers will be in the new layer, test antigens: {}", chart2_->name(), test_indexes);
+            AD_INFO("cheating assay ({}) will be combined, no reference titers will be in the new layer, test antigens: {}", chart2.name(), test_indexes);
             return test_indexes;
         }
         else {
@@ -206,60 +394,96 @@ ae::antigen_indexes ae::chart::v3::merge_data_t::secondary_antigens_to_merge(con
         }
     }
 
-    return index_range(chart2_->antigens().size()); // no cheating assay or combining not requested
+    return index_range(chart2.antigens().size()); // no cheating assay or combining not requested
 
-} // ae::chart::v3::merge_data_t::secondary_antigens_to_merge
+} // ae::chart::v3::secondary_antigens_to_merge
+
+// ----------------------------------------------------------------------
+
+void ae::chart::v3::append_layers(Titers& merge_titers, const Titers& source, const std::vector<antigen_index>& antigen_target, const std::vector<serum_index>& serum_target, antigen_index number_of_antigens)
+{
+    const auto copy_titers = [&](const auto& titer_iterator_gen) {
+        sparse_titers_builder_t layer{number_of_antigens};
+        for (auto titer_ref : titer_iterator_gen) {
+            const auto ag_no = antigen_target[*titer_ref.antigen];
+            const auto sr_no = serum_target[*titer_ref.serum];
+            if (ag_no != antigen_index{invalid_index} && sr_no != serum_index{invalid_index})
+                layer.add(ag_no, sr_no, titer_ref.titer);
+        }
+        merge_titers.layers().push_back(layer.build());
+    };
+
+    if (source.number_of_layers() > layer_index{1}) {
+        for (const auto source_layer_no : source.number_of_layers())
+            copy_titers(source.titers_existing_from_layer(source_layer_no));
+    }
+    else
+        copy_titers(source.titers_existing());
+
+} // ae::chart::v3::append_layers
 
 // ----------------------------------------------------------------------
 
 void ae::chart::v3::merge_info(Chart& merge, const Chart& chart1, const Chart& chart2)
 {
     merge.info().virus(chart1.info().virus());
-    if (chart1.info().sources().empty())
-        merge.info().sources().push_back(chart1.info());
-    else
-        std::copy(chart1.info().sources().begin(), chart1.info().sources().end(), std::back_inserter(merge.info().sources()));
-    if (chart2.info().sources().empty())
-        merge.info().sources().push_back(chart2.info());
+    merge_info_sources(merge, chart1);
+    merge_info_sources(merge, chart2);
+    merge_info_derived(merge);
+
+} // ae::chart::v3::merge_info
+
+// ----------------------------------------------------------------------
+
+void ae::chart::v3::merge_info_sources(Chart& merge, const Chart& source)
+{
+    if (source.info().sources().empty())
+        merge.info().sources().push_back(source.info());
     else
-        std::copy(chart2.info().sources().begin(), chart2.info().sources().end(), std::back_inserter(merge.info().sources()));
+        std::copy(source.info().sources().begin(), source.info().sources().end(), std::back_inserter(merge.info().sources()));
+
+} // ae::chart::v3::merge_info_sources
+
+// ----------------------------------------------------------------------
 
+void ae::chart::v3::merge_info_derived(Chart& merge)
+{
     merge.info().type_subtype(ae::virus::type_subtype_t{merge.info().make_virus_type()});
     merge.info().assay(Assay{merge.info().make_assay(Assay::assay_name_t::brief)});
     merge.info().rbc_species(RbcSpecies{merge.info().make_rbc_species()});
     merge.info().lab(Lab{merge.info().make_lab()});
 
-} // ae::chart::v3::merge_info
+} // ae::chart::v3::merge_info_derived
 
 // ----------------------------------------------------------------------
 
 ae::chart::v3::Titers::titer_merge_report ae::chart::v3::merge_titers(Chart& merge, const Chart& chart1, const Chart& chart2, const merge_data_t& merge_data)
 {
-    auto &titers = merge.titers(), titers1 = chart1.titers(), titers2 = chart2.titers();
+    auto& titers = merge.titers();
+    const auto &titers1 = chart1.titers(), &titers2 = chart2.titers();
     auto layers1 = titers1.number_of_layers(), layers2 = titers2.number_of_layers();
     titers.create_layers((layers1 > layer_index{1} ? layers1 : layer_index{1}) + (layers2 > layer_index{1} ? layers2 : layer_index{1}), merge.antigens().size());
 
     layer_index target_layer_no{0};
-    const auto copy_layers = [&target_layer_no, &titers](layer_index source_layers, const Titers& source_titers, const auto& antigen_target, const auto& serum_target) {
-        const auto assign = [&target_layer_no, &titers](antigen_index ag_no, serum_index sr_no, const Titer& titer) { titers.set_titer_of_layer(target_layer_no, ag_no, sr_no, titer); };
-        auto copy_titer = [assign, &antigen_target, &serum_target](const auto& titer_iterator_gen) {
+    const auto copy_layers = [&target_layer_no, &titers, number_of_antigens = merge.antigens().size()](layer_index source_layers, const Titers& source_titers, const auto& antigen_target, const auto& serum_target) {
+        auto copy_titer = [&target_layer_no, &titers, number_of_antigens, &antigen_target, &serum_target](const auto& titer_iterator_gen) {
+            sparse_titers_builder_t layer{number_of_antigens};
             for (auto titer_ref : titer_iterator_gen) {
                 const auto ag_no = antigen_target.find(titer_ref.antigen);
                 const auto sr_no = serum_target.find(titer_ref.serum);
                 if (ag_no != antigen_target.end() && sr_no != serum_target.end())
-                    assign(ag_no->second.index, sr_no->second.index, titer_ref.titer);
+                    layer.add(ag_no->second.index, sr_no->second.index, titer_ref.titer);
             }
+            titers.layer(target_layer_no) = layer.build();
+            ++target_layer_no;
         };
 
         if (source_layers > layer_index{1}) {
-            for (const auto source_layer_no : source_layers) {
+            for (const auto source_layer_no : source_layers)
                 copy_titer(source_titers.titers_existing_from_layer(source_layer_no));
-                ++target_layer_no;
-            }
         }
         else {
             copy_titer(source_titers.titers_existing());
-            ++target_layer_no;
         }
     };
     copy_layers(layers1, titers1, merge_data.antigens_primary_target(), merge_data.sera_primary_target());
@@ -72,13 +72,62 @@ namespace ae::chart::v3
         Titers::titer_merge_report titer_report_{};
 
         void build(const merge_settings_t& settings);
-        antigen_indexes secondary_antigens_to_merge(const merge_settings_t& settings) const;
+    };
+
+    // ----------------------------------------------------------------------
+
+    // merge of many charts: common antigens/sera of the last chart and all
+    // charts before it (the same as merge_data_t::common_report(0) of the
+    // last pairwise merge), merged titers
+    struct merge_report_t
+    {
+        std::string common{};
+        Titers::titer_merge_report titers{};
     };
 
     // ----------------------------------------------------------------------
 
     std::pair<std::shared_ptr<Chart>, merge_data_t> merge(std::shared_ptr<Chart> chart1, std::shared_ptr<Chart> chart2, const merge_settings_t& settings);
 
+    // Single pass merge, the result is the same as merging charts pairwise
+    // in order: each chart is matched against antigens/sera merged so far,
+    // its layers are appended and merged titers are set once at the end.
+    // Only projection_merge_t::type1 (no projections) and remove_distinct::no
+    // are supported.
+    std::pair<std::shared_ptr<Chart>, merge_report_t> merge(const std::vector<std::shared_ptr<Chart>>& charts, const merge_settings_t& settings);
+
+    // ----------------------------------------------------------------------
+
+    // Appends charts to a merged chart (e.g. result of merge()) in place:
+    // antigens/sera of the merged chart keep their indexes and layers, new
+    // antigens, sera and layers are appended. Designation index of the
+    // merged chart is built once and kept between append() calls. finish()
+    // recomputes merged titers only for antigens having titers in the
+    // appended layers, rebuild of all merged titers is available for
+    // verification. Projections of the merged chart are removed. Only
+    // projection_merge_t::type1 and remove_distinct::no are supported.
+    class cumulative_merge_t
+    {
+      public:
+        enum class merged_titers { update, rebuild };
+
+        cumulative_merge_t(std::shared_ptr<Chart> merged, const merge_settings_t& settings);
+
+        void append(const Chart& chart);
+        // can be called after each batch of appends
+        merge_report_t finish(merged_titers recompute = merged_titers::update);
+
+        std::shared_ptr<Chart> merged() const { return merged_; }
+
+      private:
+        std::shared_ptr<Chart> merged_;
+        merge_settings_t settings_;
+        common_data_t<Antigens>::primary_index_t antigens_index_;
+        common_data_t<Sera>::primary_index_t sera_index_;
+        layer_index first_new_layer_; // 0: merged titers were not set from layers
+        std::string common_report_{};
+    };
+
 } // namespace ae::chart::v3
 
 // ----------------------------------------------------------------------
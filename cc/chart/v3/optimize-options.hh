@@ -3,6 +3,8 @@
 #include <stdexcept>
 #include <vector>
 #include <algorithm>
+#include <optional>
+#include <cstdint>
 
 #include "chart/v3/index.hh"
 #include "chart/v3/optimization-precision.hh"
@@ -27,6 +29,7 @@ namespace ae::chart::v3
     constexpr inline use_dimension_annealing use_dimension_annealing_from_bool(bool use) { return use ? use_dimension_annealing::yes : use_dimension_annealing::no; }
     enum class remove_source_projection { no, yes }; // for relax_incremental
     enum class unmovable_non_nan_points { no, yes }; // for relax_incremental, points that have coordinates (not NaN) are marked as unmovable
+    enum class use_relax_cache { no, yes };          // for relax, see chart/v3/relax-cache.hh
 
     struct optimization_options
     {
@@ -35,11 +38,14 @@ namespace ae::chart::v3
         disconnect_few_numeric_titers disconnect_too_few_numeric_titers{disconnect_few_numeric_titers::yes};
         multiply_antigen_titer_until_column_adjust mult{multiply_antigen_titer_until_column_adjust::yes};
         double randomization_diameter_multiplier{2.0}; // for layout randomizations
+        std::optional<std::uint_fast32_t> seed{};      // for layout randomizations, std::random_device if not set
+        size_t first_optimization{0};                  // ordinal of the first optimization in the seeded layout randomizations, to continue seeded relax in several calls
         int num_threads{0};                            // 0 - omp_get_max_threads()
         use_dimension_annealing dimension_annealing{use_dimension_annealing::no};
         remove_source_projection rsp{remove_source_projection::yes};
         unmovable_non_nan_points unnp{unmovable_non_nan_points::no};
         dodgy_titer_is_regular_e dodgy_titer_is_regular{dodgy_titer_is_regular_e::no};
+        use_relax_cache cache{use_relax_cache::yes};   // no - bypass relax cache, results are neither looked up nor stored
 
     }; // struct optimization_options
 
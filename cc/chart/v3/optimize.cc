@@ -120,21 +120,35 @@ ae::chart::v3::optimization_status ae::chart::v3::optimize(optimization_method o
     optimization_status status(optimization_method);
     status.initial_stress = callback_data.stress.value(args);
     const auto start = std::chrono::high_resolution_clock::now();
-    switch (optimization_method) {
-        case optimization_method::alglib_lbfgs_pca:
-            alglib::lbfgs_optimize(status, callback_data, args, precision);
-            break;
-        case optimization_method::alglib_cg_pca:
-            alglib::cg_optimize(status, callback_data, args, precision);
-            break;
-        // case optimization_method::optimlib_bfgs_pca:
-        //     optim::bfgs(status, callback_data, args, precision);
-        //     break;
-        // case optimization_method::optimlib_differential_evolution:
-        //     optim::differential_evolution(status, callback_data, args, precision);
-        //     alglib::cg_optimize(status, callback_data, args, precision);
-        //     break;
+    const auto run = [optimization_method, args, precision, &status](OptimiserCallbackData& data) {
+        switch (optimization_method) {
+            case optimization_method::alglib_lbfgs_pca:
+                alglib::lbfgs_optimize(status, data, args, precision);
+                break;
+            case optimization_method::alglib_cg_pca:
+                alglib::cg_optimize(status, data, args, precision);
+                break;
+                // case optimization_method::optimlib_bfgs_pca:
+                //     optim::bfgs(status, data, args, precision);
+                //     break;
+                // case optimization_method::optimlib_differential_evolution:
+                //     optim::differential_evolution(status, data, args, precision);
+                //     alglib::cg_optimize(status, data, args, precision);
+                //     break;
+        }
+    };
+    // with unmovable points (relax_incremental, merge type 4 and 5)
+    // the engine sees just the table distances involving movable
+    // points, initial and final stress are still computed for the
+    // whole layout. Intermediate layouts report stress seen by the
+    // engine, so the active set is not used when they are requested.
+    if (!callback_data.stress.parameters().unmovable->empty() && callback_data.intermediate_layouts == nullptr) {
+        const auto active = callback_data.stress.active_set();
+        OptimiserCallbackData active_callback_data{active};
+        run(active_callback_data);
     }
+    else
+        run(callback_data);
     status.time = std::chrono::duration_cast<decltype(status.time)>(std::chrono::high_resolution_clock::now() - start);
     status.final_stress = callback_data.stress.value(args);
     return status;
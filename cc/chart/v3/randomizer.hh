@@ -35,10 +35,17 @@ namespace ae::chart::v3
      public:
         using seed_t = std::optional<std::uint_fast32_t>;
 
-        LayoutRandomizer(seed_t seed = std::nullopt) : generator_(seed ? *seed : std::random_device{}()) {}
+        LayoutRandomizer(seed_t seed = std::nullopt) : seed_{seed ? *seed : std::random_device{}()}, generator_(seed_) {}
         // LayoutRandomizer(LayoutRandomizer&&) = default;
         virtual ~LayoutRandomizer() = default;
 
+        // Independent randomizer for the optimization with the passed
+        // ordinal, its values depend on seed() and ordinal only (not on the
+        // number of threads and their scheduling in relax). std::seed_seq
+        // is fully specified by the standard, results are reproducible.
+        virtual std::unique_ptr<LayoutRandomizer> stream(size_t ordinal) const = 0;
+        std::uint_fast32_t seed() const { return seed_; }
+
         virtual point_coordinates get(number_of_dimensions_t number_of_dimensions)
             {
                 point_coordinates result(number_of_dimensions);
@@ -47,14 +54,23 @@ namespace ae::chart::v3
             }
 
      protected:
+        LayoutRandomizer(std::uint_fast32_t seed, size_t ordinal) : seed_{seed}, generator_(stream_generator(seed, ordinal)) {}
+
         virtual double get() = 0;
         auto& generator() { return generator_; }
 
      private:
         // std::random_device rd_;
+        std::uint_fast32_t seed_;
         std::mt19937 generator_;
         // mt19937_2002 generator_;
 
+        static std::mt19937 stream_generator(std::uint_fast32_t seed, size_t ordinal)
+        {
+            std::seed_seq seq{static_cast<std::uint_fast64_t>(seed), static_cast<std::uint_fast64_t>(ordinal), static_cast<std::uint_fast64_t>(ordinal) >> 32};
+            return std::mt19937{seq};
+        }
+
     }; // class LayoutRandomizer
 
 // ----------------------------------------------------------------------
@@ -70,12 +86,17 @@ namespace ae::chart::v3
             }
           // LayoutRandomizerPlain(LayoutRandomizerPlain&&) = default;
 
+        std::unique_ptr<LayoutRandomizer> stream(size_t ordinal) const override { return std::unique_ptr<LayoutRandomizerPlain>{new LayoutRandomizerPlain(diameter_, seed(), ordinal)}; }
+
         void diameter(double diameter) { diameter_ = diameter; check(); distribution_ = std::uniform_real_distribution<>(-diameter / 2, diameter / 2); }
         double diameter() const { return diameter_; } // std::abs(distribution_.a() - distribution_.b()); }
 
         using LayoutRandomizer::get;
 
      protected:
+        LayoutRandomizerPlain(double diameter, std::uint_fast32_t seed, size_t ordinal)
+            : LayoutRandomizer(seed, ordinal), diameter_{diameter}, distribution_(-diameter / 2, diameter / 2) {}
+
         double get() override {
             std::lock_guard<std::mutex> guard(generator_access_);
             return distribution_(generator());
@@ -109,11 +130,15 @@ namespace ae::chart::v3
             : LayoutRandomizerPlain(diameter, seed), line_side_(line_side) {}
 
         point_coordinates get(number_of_dimensions_t number_of_dimensions) override { return line().fix(LayoutRandomizerPlain::get(number_of_dimensions)); }
+        std::unique_ptr<LayoutRandomizer> stream(size_t ordinal) const override { return std::unique_ptr<LayoutRandomizerWithLineBorder>{new LayoutRandomizerWithLineBorder(diameter(), line_side_, seed(), ordinal)}; }
 
         ae::draw::v2::LineSide& line() { return line_side_; }
         const ae::draw::v2::LineSide& line() const { return line_side_; }
 
      protected:
+        LayoutRandomizerWithLineBorder(double diameter, const ae::draw::v2::LineSide& line_side, std::uint_fast32_t seed, size_t ordinal)
+            : LayoutRandomizerPlain(diameter, seed, ordinal), line_side_(line_side) {}
+
         using LayoutRandomizerPlain::get;
 
      private:
@@ -0,0 +1,220 @@
+#include <cstring>
+#include <algorithm>
+#include <unistd.h>
+
+#include "ext/hash.hh"
+#include "utils/log.hh"
+#include "utils/file.hh"
+#include "chart/v3/relax-cache.hh"
+#include "chart/v3/chart.hh"
+#include "chart/v3/chart-binary.hh"
+#include "chart/v3/stress.hh"
+
+// ----------------------------------------------------------------------
+
+namespace ae::chart::v3::relax_cache
+{
+    // changing it invalidates existing entries, e.g. when optimization code changes results
+    constexpr uint32_t key_version{2};
+
+    static settings_t settings_{};
+
+    template <typename T> inline void append(std::string& out, const T& data) { out.append(reinterpret_cast<const char*>(&data), sizeof(T)); }
+
+    inline void append(std::string& out, const point_indexes& points)
+    {
+        std::vector<size_t> sorted(points.size());
+        std::transform(points.begin(), points.end(), sorted.begin(), [](point_index pnt) { return *pnt; });
+        std::sort(sorted.begin(), sorted.end());
+        append(out, sorted.size());
+        out.append(reinterpret_cast<const char*>(sorted.data()), sorted.size() * sizeof(size_t));
+    }
+
+    inline std::filesystem::path entry_path(uint64_t key) { return settings_.directory / fmt::format("{:016x}.acb", key); }
+
+    static void evict();
+
+} // namespace ae::chart::v3::relax_cache
+
+// ----------------------------------------------------------------------
+
+const ae::chart::v3::relax_cache::settings_t& ae::chart::v3::relax_cache::settings()
+{
+    return settings_;
+
+} // ae::chart::v3::relax_cache::settings
+
+// ----------------------------------------------------------------------
+
+void ae::chart::v3::relax_cache::settings(const settings_t& new_settings)
+{
+    settings_ = new_settings;
+
+} // ae::chart::v3::relax_cache::settings
+
+// ----------------------------------------------------------------------
+
+std::optional<uint64_t> ae::chart::v3::relax_cache::key(const Chart& chart, number_of_optimizations_t number_of_optimizations, minimum_column_basis mcb, number_of_dimensions_t number_of_dimensions,
+                                                        const optimization_options& options, const StressParameters& parameters)
+{
+    // unseeded relax is not reproducible, returning stored results would make repeated calls produce the same projections
+    if (settings_.directory.empty() || options.cache == use_relax_cache::no || !options.seed.has_value())
+        return std::nullopt;
+
+    std::string source;
+    append(source, key_version);
+    append(source, table_hash(chart, mcb));
+
+    append(source, parameters.disconnected);
+    append(source, parameters.unmovable);
+
+    append(source, *number_of_optimizations);
+    append(source, *number_of_dimensions);
+    append(source, options.method);
+    append(source, options.precision);
+    append(source, options.disconnect_too_few_numeric_titers);
+    append(source, options.mult);
+    append(source, options.randomization_diameter_multiplier);
+    append(source, static_cast<uint64_t>(*options.seed));
+    append(source, options.first_optimization);
+    append(source, options.dimension_annealing);
+    append(source, options.dodgy_titer_is_regular);
+
+    return xxhash::xxhash64(source);
+
+} // ae::chart::v3::relax_cache::key
+
+// ----------------------------------------------------------------------
+
+uint64_t ae::chart::v3::relax_cache::table_hash(const Chart& chart, minimum_column_basis mcb)
+{
+    std::string source;
+    const auto& titers = chart.titers();
+    append(source, *chart.antigens().size());
+    append(source, *chart.sera().size());
+    const auto append_titers = [&source](const auto& existing) {
+        for (const auto& entry : existing) {
+            append(source, *entry.antigen);
+            append(source, *entry.serum);
+            append(source, entry.titer.encoded());
+        }
+        append(source, ~size_t{0}); // end of table
+    };
+    append_titers(titers.titers_existing());
+    for (const auto layer_no : titers.number_of_layers())
+        append_titers(titers.titers_existing_from_layer(layer_no));
+
+    append(source, static_cast<double>(mcb));
+    const auto column_bases = chart.column_bases(mcb); // incl. forced column bases
+    for (const auto sr_no : chart.sera().size())
+        append(source, column_bases[sr_no]);
+
+    return xxhash::xxhash64(source);
+
+} // ae::chart::v3::relax_cache::table_hash
+
+// ----------------------------------------------------------------------
+
+bool ae::chart::v3::relax_cache::load(uint64_t key, Chart& chart, number_of_optimizations_t number_of_optimizations, minimum_column_basis mcb, const StressParameters& parameters)
+{
+    const auto filename = entry_path(key);
+    if (!std::filesystem::exists(filename))
+        return false;
+
+    try {
+        const binary::view_t view{filename};
+        // metadata: float64 stress of each projection
+        const auto metadata = view.metadata();
+        if (view.number_of_projections() != projection_index{*number_of_optimizations} || metadata.size() != *number_of_optimizations * sizeof(double))
+            throw std::runtime_error{"unexpected number of projections"};
+        for (const auto projection_no : view.number_of_projections()) {
+            if (view.layout(projection_no).size() != *chart.number_of_points() * *view.number_of_dimensions(projection_no))
+                throw std::runtime_error{"unexpected number of points"};
+        }
+
+        for (const auto projection_no : view.number_of_projections()) {
+            const auto layout = view.layout(projection_no);
+            auto& projection = chart.projections().add(chart.number_of_points(), view.number_of_dimensions(projection_no), mcb);
+            projection.layout() = Layout{view.number_of_dimensions(projection_no), layout.data(), layout.data() + layout.size()};
+            projection.disconnected() = parameters.disconnected;
+            projection.unmovable() = parameters.unmovable;
+            double stress;
+            std::memcpy(&stress, metadata.data() + *projection_no * sizeof(double), sizeof(double));
+            projection.stress(stress);
+        }
+    }
+    catch (std::exception& err) {
+        AD_WARNING("relax cache: invalid entry {}: {}", filename, err.what());
+        std::filesystem::remove(filename);
+        return false;
+    }
+
+    std::error_code ec; // may have been evicted by another process meanwhile, projections are already loaded
+    std::filesystem::last_write_time(filename, std::filesystem::file_time_type::clock::now(), ec); // for eviction
+    return true;
+
+} // ae::chart::v3::relax_cache::load
+
+// ----------------------------------------------------------------------
+
+void ae::chart::v3::relax_cache::store(uint64_t key, const Chart& chart, projection_index first)
+{
+    std::string stresses;
+    for (auto projection_no = first; projection_no < chart.projections().size(); ++projection_no)
+        append(stresses, chart.projections()[projection_no].stress());
+
+    try {
+        std::filesystem::create_directories(settings_.directory);
+        // other processes may use the same cache, the entry appears atomically
+        const auto filename = entry_path(key);
+        const auto temp = settings_.directory / fmt::format(".{:016x}.{}.acb", key, getpid());
+        file::write(temp, binary::export_layouts(stresses, chart.projections(), first), file::force_compression::no, file::backup_file::no);
+        std::filesystem::rename(temp, filename);
+        evict();
+    }
+    catch (std::exception& err) {
+        AD_WARNING("relax cache: cannot store {:016x} in {}: {}", key, settings_.directory, err.what());
+    }
+
+} // ae::chart::v3::relax_cache::store
+
+// ----------------------------------------------------------------------
+
+void ae::chart::v3::relax_cache::evict()
+{
+    struct entry_t
+    {
+        std::filesystem::path path;
+        std::filesystem::file_time_type modified;
+        uintmax_t size;
+    };
+
+    std::vector<entry_t> entries;
+    uintmax_t total_size{0};
+    for (const auto& dir_entry : std::filesystem::directory_iterator{settings_.directory}) {
+        if (dir_entry.path().extension() == ".acb" && !dir_entry.path().filename().native().starts_with(".")) {
+            // entries removed by another process while iterating are skipped
+            std::error_code ec;
+            if (!dir_entry.is_regular_file(ec) || ec)
+                continue;
+            entry_t entry{.path = dir_entry.path(), .modified = dir_entry.last_write_time(ec), .size = 0};
+            if (ec)
+                continue;
+            entry.size = dir_entry.file_size(ec);
+            if (ec)
+                continue;
+            total_size += entry.size;
+            entries.push_back(std::move(entry));
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const auto& e1, const auto& e2) { return e1.modified < e2.modified; });
+    for (auto entry = entries.begin(); total_size > settings_.size_limit && entry != entries.end(); ++entry) {
+        std::error_code ec; // may have been removed by another process
+        std::filesystem::remove(entry->path, ec);
+        total_size -= entry->size;
+    }
+
+} // ae::chart::v3::relax_cache::evict
+
+// ----------------------------------------------------------------------
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <optional>
+#include <cstdint>
+
+#include "ext/filesystem.hh"
+#include "chart/v3/index.hh"
+#include "chart/v3/optimize-options.hh"
+#include "chart/v3/column-bases.hh"
+
+// ----------------------------------------------------------------------
+
+namespace ae::chart::v3
+{
+    class Chart;
+    struct StressParameters;
+
+    // On-disk cache of Chart::relax results. Seeded relax is reproducible
+    // (see LayoutRandomizer::stream), the same relax of the same table
+    // returns the projections stored by the previous run instead of
+    // optimizing again. Key is xxhash64 of the encoded titers (incl.
+    // layers), column bases, disconnected and unmovable points, number
+    // of optimizations and dimensions and optimization_options (except
+    // num_threads which does not affect results). Entries are binary
+    // layout containers (chart/v3/chart-binary.hh) named <key>.acb.
+    namespace relax_cache
+    {
+        // process wide, directory: caching is off if empty, size_limit:
+        // least recently used entries are removed when total size of the
+        // entries exceeds it
+        struct settings_t
+        {
+            std::filesystem::path directory{};
+            size_t size_limit{1ul << 30};
+        };
+
+        const settings_t& settings();
+        void settings(const settings_t& new_settings);
+
+        // nullopt if caching is off, bypassed in options or relax is not seeded
+        std::optional<uint64_t> key(const Chart& chart, number_of_optimizations_t number_of_optimizations, minimum_column_basis mcb, number_of_dimensions_t number_of_dimensions,
+                                    const optimization_options& options, const StressParameters& parameters);
+
+        // xxhash64 of the encoded titers (incl. layers) and column bases
+        // (incl. forced column bases) for mcb, part of the key
+        uint64_t table_hash(const Chart& chart, minimum_column_basis mcb);
+
+        // adds stored projections to the chart, returns false if there is no (valid) entry for the key
+        bool load(uint64_t key, Chart& chart, number_of_optimizations_t number_of_optimizations, minimum_column_basis mcb, const StressParameters& parameters);
+
+        // stores projections of the chart starting with first, evicts old entries
+        void store(uint64_t key, const Chart& chart, projection_index first);
+
+    } // namespace relax_cache
+
+} // namespace ae::chart::v3
+
+// ----------------------------------------------------------------------
@@ -0,0 +1,218 @@
+#include "ext/simdjson.hh"
+#include "ext/hash.hh"
+#include "utils/string.hh"
+#include "utils/file.hh"
+#include "chart/v3/relax-checkpoint.hh"
+#include "chart/v3/relax-cache.hh"
+#include "chart/v3/chart.hh"
+#include "chart/v3/chart-binary.hh"
+
+// ----------------------------------------------------------------------
+
+namespace ae::chart::v3::relax_checkpoint
+{
+    // key and json token of each value that must be the same when resuming,
+    // num_threads, cache and checkpoint_every do not affect results
+    using description_t = std::vector<std::pair<std::string, std::string>>;
+
+    // titers and column bases (as in relax cache key) and designations of antigens and sera
+    static uint64_t table_hash(const Chart& chart, minimum_column_basis mcb)
+    {
+        std::string source;
+        const auto table = relax_cache::table_hash(chart, mcb);
+        source.append(reinterpret_cast<const char*>(&table), sizeof(table));
+        for (const auto& antigen : chart.antigens())
+            source.append(antigen.designation()).append(1, '\n');
+        for (const auto& serum : chart.sera())
+            source.append(serum.designation()).append(1, '\n');
+        return xxhash::xxhash64(source);
+    }
+
+    static description_t describe(const Chart& chart, const parameters_t& parameters)
+    {
+        const auto& opt = parameters.optimization;
+        const minimum_column_basis mcb{parameters.minimum_column_basis};
+        return description_t{
+            {"table", fmt::format("\"{:016x}\"", table_hash(chart, mcb))},
+            {"number_of_optimizations", fmt::format("{}", parameters.number_of_optimizations)},
+            {"number_of_dimensions", fmt::format("{}", *parameters.number_of_dimensions)},
+            {"minimum_column_basis", fmt::format("\"{}\"", static_cast<std::string>(mcb))},
+            {"keep_projections", fmt::format("{}", parameters.keep_projections)},
+            {"method", fmt::format("\"{}\"", opt.method)},
+            {"precision", fmt::format("\"{}\"", opt.precision)},
+            {"disconnect_too_few_numeric_titers", fmt::format("{}", opt.disconnect_too_few_numeric_titers == disconnect_few_numeric_titers::yes)},
+            {"mult", fmt::format("{}", opt.mult == multiply_antigen_titer_until_column_adjust::yes)},
+            {"randomization_diameter_multiplier", fmt::format("{}", opt.randomization_diameter_multiplier)},
+            {"seed", opt.seed ? fmt::format("{}", *opt.seed) : std::string{"null"}},
+            {"dimension_annealing", fmt::format("{}", opt.dimension_annealing == use_dimension_annealing::yes)},
+            {"dodgy_titer_is_regular", fmt::format("{}", opt.dodgy_titer_is_regular == dodgy_titer_is_regular_e::yes)},
+        };
+    }
+
+    static size_t resume(Chart& chart, const parameters_t& parameters, const std::filesystem::path& checkpoint);
+    static void write(const Chart& chart, const parameters_t& parameters, const std::filesystem::path& checkpoint, size_t completed);
+
+} // namespace ae::chart::v3::relax_checkpoint
+
+// ----------------------------------------------------------------------
+
+size_t ae::chart::v3::relax_checkpoint::relax(Chart& chart, const parameters_t& parameters, const std::optional<std::filesystem::path>& checkpoint, size_t checkpoint_every,
+                                              const std::function<void(size_t)>& progress)
+{
+    // kept until the end, only projections made by this run are in the checkpoint
+    auto original = std::move(chart.projections());
+    chart.projections() = Projections{};
+
+    size_t completed{0};
+    if (checkpoint && std::filesystem::exists(*checkpoint)) {
+        completed = resume(chart, parameters, *checkpoint);
+        if (progress)
+            progress(completed);
+    }
+    const auto resumed = completed;
+
+    const auto batch_size = checkpoint && checkpoint_every > 0 ? checkpoint_every : parameters.number_of_optimizations;
+    while (completed < parameters.number_of_optimizations) {
+        const auto batch = std::min(batch_size, parameters.number_of_optimizations - completed);
+        auto optimization = parameters.optimization;
+        optimization.first_optimization = completed; // seeded relax: the same starting layouts as in a single uninterrupted run
+        chart.relax(number_of_optimizations_t{batch}, minimum_column_basis{parameters.minimum_column_basis}, parameters.number_of_dimensions, optimization);
+        completed += batch;
+        chart.projections().sort(chart);
+        if (parameters.keep_projections > 0)
+            chart.projections().keep(projection_index{parameters.keep_projections});
+        if (checkpoint && completed < parameters.number_of_optimizations) {
+            write(chart, parameters, *checkpoint, completed);
+            if (progress)
+                progress(completed);
+        }
+    }
+
+    // the best of the kept new projections are the best of all new ones, selecting among them and the original ones
+    // gives the same result as sorting and keeping all together after each batch
+    if (!original.empty()) {
+        for (const auto& projection : original)
+            chart.projections().add(projection);
+        chart.projections().sort(chart);
+        if (parameters.keep_projections > 0)
+            chart.projections().keep(projection_index{parameters.keep_projections});
+    }
+    return resumed;
+
+} // ae::chart::v3::relax_checkpoint::relax
+
+// ----------------------------------------------------------------------
+
+size_t ae::chart::v3::relax_checkpoint::resume(Chart& chart, const parameters_t& parameters, const std::filesystem::path& checkpoint)
+{
+    try {
+        const binary::view_t view{checkpoint};
+        ae::simdjson::Parser parser{view.metadata()};
+
+        size_t completed{0};
+        description_t description;
+        std::vector<double> stresses;
+        std::vector<disconnected_points> disconnected;
+        std::vector<unmovable_points> unmovable;
+        const auto read_points = [](auto& target, ::simdjson::ondemand::value source) {
+            auto& points = target.emplace_back();
+            for (auto point : source.get_array())
+                points.push_back(point_index{static_cast<uint64_t>(point)});
+        };
+        for (auto field : parser.doc().get_object()) {
+            if (const std::string_view key = field.unescaped_key(); key == "completed") {
+                completed = static_cast<uint64_t>(field.value());
+            }
+            else if (key == "parameters") {
+                for (auto p_field : field.value().get_object()) {
+                    ::simdjson::ondemand::value value = p_field.value();
+                    description.emplace_back(static_cast<std::string_view>(p_field.unescaped_key()), ae::string::strip(static_cast<std::string_view>(value.raw_json_token())));
+                }
+            }
+            else if (key == "projections") {
+                for (auto projection : field.value().get_array()) {
+                    for (auto p_field : projection.get_object()) {
+                        if (const std::string_view p_key = p_field.unescaped_key(); p_key == "s")
+                            stresses.push_back(static_cast<double>(p_field.value()));
+                        else if (p_key == "D")
+                            read_points(disconnected, p_field.value());
+                        else if (p_key == "U")
+                            read_points(unmovable, p_field.value());
+                    }
+                }
+            }
+        }
+
+        if (const auto expected = describe(chart, parameters); description != expected) {
+            std::vector<std::string> mismatches;
+            for (const auto& [key, value] : expected) {
+                if (const auto found = std::find_if(description.begin(), description.end(), [&key](const auto& entry) { return entry.first == key; }); found == description.end())
+                    mismatches.push_back(fmt::format("{}: {} (not in checkpoint)", key, value));
+                else if (found->second != value)
+                    mismatches.push_back(fmt::format("{}: {} (checkpoint: {})", key, value, found->second));
+            }
+            if (mismatches.empty())
+                mismatches.push_back("unexpected parameters in checkpoint");
+            throw Error{"relax checkpoint {} was made for another table or with other parameters: {}", checkpoint, fmt::join(mismatches, ", ")};
+        }
+
+        if (completed == 0 || view.number_of_projections() != projection_index{stresses.size()} || disconnected.size() != stresses.size() || unmovable.size() != stresses.size())
+            throw Error{"relax checkpoint {}: inconsistent data", checkpoint};
+        const minimum_column_basis mcb{parameters.minimum_column_basis};
+        for (const auto projection_no : view.number_of_projections()) {
+            const auto layout = view.layout(projection_no);
+            const auto number_of_dimensions = view.number_of_dimensions(projection_no);
+            if (layout.size() != *chart.number_of_points() * *number_of_dimensions)
+                throw Error{"relax checkpoint {}: unexpected number of points", checkpoint};
+            auto& projection = chart.projections().add(chart.number_of_points(), number_of_dimensions, mcb);
+            projection.layout() = Layout{number_of_dimensions, layout.data(), layout.data() + layout.size()};
+            projection.stress(stresses[*projection_no]);
+            projection.disconnected() = std::move(disconnected[*projection_no]);
+            projection.unmovable() = std::move(unmovable[*projection_no]);
+        }
+        return completed;
+    }
+    catch (Error&) {
+        throw;
+    }
+    catch (std::exception& err) {
+        throw Error{"cannot read relax checkpoint {}: {}", checkpoint, err.what()};
+    }
+
+} // ae::chart::v3::relax_checkpoint::resume
+
+// ----------------------------------------------------------------------
+
+void ae::chart::v3::relax_checkpoint::write(const Chart& chart, const parameters_t& parameters, const std::filesystem::path& checkpoint, size_t completed)
+{
+    fmt::memory_buffer metadata;
+    fmt::format_to(std::back_inserter(metadata), "{{\"completed\":{},\n \"parameters\":{{", completed);
+    bool first{true};
+    for (const auto& [key, value] : describe(chart, parameters)) {
+        fmt::format_to(std::back_inserter(metadata), "{}\"{}\":{}", first ? "" : ",", key, value);
+        first = false;
+    }
+    fmt::format_to(std::back_inserter(metadata), "}},\n \"projections\":[");
+    const auto append_points = [&metadata](std::string_view key, const point_indexes& points) {
+        fmt::format_to(std::back_inserter(metadata), ",\"{}\":[", key);
+        for (auto pnt = points.begin(); pnt != points.end(); ++pnt)
+            fmt::format_to(std::back_inserter(metadata), "{}{}", pnt == points.begin() ? "" : ",", **pnt);
+        fmt::format_to(std::back_inserter(metadata), "]");
+    };
+    for (const auto projection_no : chart.projections().size()) {
+        const auto& projection = chart.projections()[projection_no];
+        fmt::format_to(std::back_inserter(metadata), "{}\n  {{\"s\":{}", projection_no == projection_index{0} ? "" : ",", projection.stress());
+        append_points("D", projection.disconnected());
+        append_points("U", projection.unmovable());
+        fmt::format_to(std::back_inserter(metadata), "}}");
+    }
+    fmt::format_to(std::back_inserter(metadata), "]}}\n");
+
+    // replaced atomically, an interrupted write leaves the previous checkpoint
+    file::output_sink_t sink{checkpoint, file::force_compression::no, file::backup_file::no};
+    sink.append(binary::export_layouts(std::string_view{metadata.data(), metadata.size()}, chart.projections(), projection_index{0}));
+    sink.finish();
+
+} // ae::chart::v3::relax_checkpoint::write
+
+// ----------------------------------------------------------------------
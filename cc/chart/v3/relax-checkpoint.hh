@@ -0,0 +1,49 @@
+#pragma once
+
+#include <optional>
+#include <functional>
+
+#include "ext/filesystem.hh"
+#include "chart/v3/index.hh"
+#include "chart/v3/optimize-options.hh"
+
+// ----------------------------------------------------------------------
+
+namespace ae::chart::v3
+{
+    class Chart;
+
+    // Relax in batches with checkpoints (chart-relax --checkpoint). After
+    // each batch the new projections are sorted and the best ones kept,
+    // they are written to the checkpoint file: binary layout container
+    // (chart/v3/chart-binary.hh, not compressed) with the number of
+    // completed optimizations, parameters of the run, hash of the table
+    // (titers, names, column bases) and stresses in the metadata. The file
+    // is replaced atomically, an interrupted run resumes from the last
+    // complete checkpoint. Resuming with different parameters or for a
+    // different table is an error. Projections the chart had before are
+    // not in the checkpoint, they compete with the new ones when the run
+    // completes. With optimization.seed set the result of a resumed run is
+    // the same as of an uninterrupted one.
+    namespace relax_checkpoint
+    {
+        struct parameters_t
+        {
+            size_t number_of_optimizations{100};
+            number_of_dimensions_t number_of_dimensions{2};
+            std::string minimum_column_basis{"none"};
+            size_t keep_projections{10}; // 0 - keep all
+            optimization_options optimization{};
+        };
+
+        // makes parameters.number_of_optimizations optimizations in batches of checkpoint_every (all in one batch if there is no checkpoint),
+        // progress is called with the number of completed optimizations after resuming and after each checkpoint is written,
+        // returns number of optimizations completed by the previous run (resumed from checkpoint), or 0
+        size_t relax(Chart& chart, const parameters_t& parameters, const std::optional<std::filesystem::path>& checkpoint, size_t checkpoint_every,
+                     const std::function<void(size_t)>& progress = {});
+
+    } // namespace relax_checkpoint
+
+} // namespace ae::chart::v3
+
+// ----------------------------------------------------------------------
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <utility>
 #include <unordered_set>
+#include <unordered_map>
 
 #include "utils/string.hh"
 #include "chart/v3/chart.hh"
+#include "chart/v3/attribute-index.hh"
 // #include "chart/v3/name-format.hh"
 
 // ----------------------------------------------------------------------
@@ -33,15 +36,21 @@ namespace ae::chart::v3
         enum None { None };
 
         // all antigens/sera
-        Selected(std::shared_ptr<Chart> a_chart) : chart{a_chart}, indexes(*a_chart->antigens_sera<AgSr>().size(), typename AgSr::index_t{0})
+        Selected(std::shared_ptr<Chart> a_chart) : chart{a_chart}, indexes(*std::as_const(*a_chart).antigens_sera<AgSr>().size(), typename AgSr::index_t{0})
         {
-            const auto num{a_chart->antigens_sera<AgSr>().size()};
+            const auto num{std::as_const(*a_chart).antigens_sera<AgSr>().size()};
             std::copy(num.begin(), num.end(), indexes.begin());
         }
         // no antigens/sera
         Selected(std::shared_ptr<Chart> a_chart, enum None) : chart{a_chart}, indexes{} {}
         // specified indexes
         Selected(std::shared_ptr<Chart> a_chart, const indexes_t& a_indexes) : chart{a_chart}, indexes{a_indexes} {}
+        // antigens/sera selected using attribute index, see Chart::attributes()
+        Selected(std::shared_ptr<Chart> a_chart, const selection_bits_t& bits) : chart{a_chart}, indexes{bits.to_indexes<indexes_t>()}
+        {
+            if (bits.size() != *std::as_const(*a_chart).antigens_sera<AgSr>().size())
+                throw std::invalid_argument{fmt::format("Selected: selection size {} does not match the number of antigens/sera {}", bits.size(), std::as_const(*a_chart).antigens_sera<AgSr>().size())};
+        }
         // call func for each antigen/serum and select ag/sr if func returns true
         template <typename F> Selected(std::shared_ptr<Chart> a_chart, F&& func, projection_index projection_no) : chart{a_chart}, indexes{}
         {
@@ -64,7 +73,7 @@ namespace ae::chart::v3
                 //     static_assert(std::is_invocable_v<F, void, int>, "unsupported filter function signature");
             };
 
-            const auto& ag_sr = a_chart->antigens_sera<AgSr>();
+            const auto& ag_sr = std::as_const(*a_chart).antigens_sera<AgSr>();
             for (const auto no : ag_sr.size()) {
                 if (call(no, ag_sr[no]))
                     indexes.push_back(no);
@@ -80,7 +89,7 @@ namespace ae::chart::v3
         {
             // no is not a antigen_no/serum_no, it's no in index, i.e. 0 to size()
             const auto ag_sr_no = indexes[no];
-            return std::pair<size_t, const typename AgSr::element_t&>{*ag_sr_no, chart->antigens_sera<AgSr>()[ag_sr_no]};
+            return std::pair<size_t, const typename AgSr::element_t&>{*ag_sr_no, std::as_const(*chart).antigens_sera<AgSr>()[ag_sr_no]};
             // return std::pair<typename AgSr::index_t, const typename AgSr::element_t&>{ag_sr_no, chart->antigens_sera<AgSr>()[ag_sr_no]};
             // return chart->antigens_sera<AgSr>()[ag_sr_no];
         }
@@ -138,12 +147,15 @@ namespace ae::chart::v3
 
         void filter_new(const Antigens& compare_to)
         {
-            std::unordered_set<std::string> designations;
+            // designation hashes are cached in antigens, designations are compared only if hashes are equal
+            std::unordered_multimap<uint64_t, const Antigen*> designations;
             for (const auto& ag : compare_to)
-                designations.insert(ag.designation());
-            indexes.get().erase(
-                std::remove_if(std::begin(indexes), std::end(indexes), [this, &designations](const auto& index) { return designations.contains(chart->antigens()[index].designation()); }),
-                indexes.end());
+                designations.emplace(ag.designation_hash(), &ag);
+            const auto contains = [&designations](const Antigen& ag) {
+                const auto [first, last] = designations.equal_range(ag.designation_hash());
+                return std::any_of(first, last, [&ag](const auto& entry) { return entry.second->designation() == ag.designation(); });
+            };
+            indexes.get().erase(std::remove_if(std::begin(indexes), std::end(indexes), [this, &contains](const auto& index) { return contains(std::as_const(*chart).antigens()[index]); }), indexes.end());
         }
 
         void remove(const Selected<AgSr>& to_remove)
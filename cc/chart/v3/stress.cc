@@ -353,6 +353,23 @@ void ae::chart::v3::Stress::gradient_with_unmovable(std::span<const double> args
 
 // ----------------------------------------------------------------------
 
+ae::chart::v3::Stress ae::chart::v3::Stress::active_set() const
+{
+    std::vector<bool> unmovable(parameters_.number_of_points.get(), false);
+    for (const auto p_no : parameters_.unmovable)
+        unmovable[p_no.get()] = true;
+    const auto movable = [&unmovable](const auto& entry) { return !unmovable[entry.point_1.get()] || !unmovable[entry.point_2.get()]; };
+
+    Stress result{number_of_dimensions_, parameters_.number_of_points};
+    result.parameters_ = parameters_;
+    std::copy_if(table_distances().regular().begin(), table_distances().regular().end(), std::back_inserter(result.table_distances().regular()), movable);
+    std::copy_if(table_distances().less_than().begin(), table_distances().less_than().end(), std::back_inserter(result.table_distances().less_than()), movable);
+    return result;
+
+} // ae::chart::v3::Stress::active_set
+
+// ----------------------------------------------------------------------
+
 void ae::chart::v3::Stress::set_coordinates_of_disconnected(std::span<double> args, double value, number_of_dimensions_t number_of_dimensions) const
 {
     // do not use number_of_dimensions_! after pca its value is wrong!
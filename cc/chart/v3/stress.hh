@@ -78,6 +78,13 @@ namespace ae::chart::v3
 
         void set_coordinates_of_disconnected(std::span<double> args, double value, number_of_dimensions_t number_of_dimensions) const;
 
+        // copy of this stress without table distances between two
+        // unmovable points: they do not contribute to the gradient and
+        // add a constant to the value, dropping them makes relaxing a
+        // layout with mostly unmovable points (merge type 4 and 5)
+        // proportional to the number of movable points
+        Stress active_set() const;
+
       private:
         number_of_dimensions_t number_of_dimensions_{0};
         TableDistances table_distances_{};
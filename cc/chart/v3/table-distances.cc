@@ -6,14 +6,19 @@
 
 void ae::chart::v3::TableDistances::update(const Titer& titer, point_index p1, point_index p2, double column_basis, double adjust, multiply_antigen_titer_until_column_adjust mult)
 {
-    try {
-        auto distance = column_basis - titer.logged() - adjust;
-        if (distance < 0 && mult == multiply_antigen_titer_until_column_adjust::yes)
-            distance = 0;
-        add_value(titer.type(), p1, p2, distance);
-    }
-    catch (invalid_titer&) {
-        // ignore dont-care
+    switch (titer.type()) {
+        case Titer::Regular:
+        case Titer::LessThan:
+        case Titer::MoreThan:
+        case Titer::Dodgy: {
+            auto distance = column_basis - titer.logged() - adjust;
+            if (distance < 0 && mult == multiply_antigen_titer_until_column_adjust::yes)
+                distance = 0;
+            add_value(titer.type(), p1, p2, distance);
+        } break;
+        case Titer::DontCare:
+        case Titer::Invalid:
+            break; // ignore dont-care
     }
 
 } // ae::chart::v3::TableDistances::update
@@ -1,4 +1,5 @@
 #include <numeric>
+#include <exception>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -9,69 +10,84 @@
 
 // ----------------------------------------------------------------------
 
-ae::chart::v3::Titers::iterator::data_sparse& ae::chart::v3::Titers::iterator::data_sparse::operator++()
+ae::chart::v3::Titer::Type ae::chart::v3::Titer::type_of_prefix(char prefix)
 {
-    if (current_row != end_rows) {
-        ++current_titer;
-        if (current_titer == end_titers) {
-            ++current_row;
-            // fmt::print(stderr, ">>>> ++ end-rows:{} empty-row:{}\n", current_row == end_rows, current_row->empty());
-            skip_empty_rows();
-        }
-    }
-    return *this;
-
-} // ae::chart::v3::Titers::data_sparse::operator++
-
-// ----------------------------------------------------------------------
-
-void ae::chart::v3::Titers::iterator::data_sparse::skip_empty_rows()
-{
-    // iterator is at the begiining of the row, but row can be empty, skip to the next row
-    while (current_row != end_rows && current_row->empty())
-        ++current_row;
-    if (current_row != end_rows) {
-        current_titer = current_row->begin();
-        end_titers = current_row->end();
-        // fmt::print(stderr, ">>>> ++ end-rows:{} empty-row:{} end_titer:{}\n", current_row == end_rows, current_row == end_rows || current_row->empty(), fmt::ptr(&*current_titer));
-    }
-    else {
-        current_titer = std::prev(current_row)->end();
-        end_titers = current_titer;
-        // fmt::print(stderr, ">>>> ++ end-rows:{} empty-row:{} end_titer:{}\n", current_row == end_rows, current_row == end_rows || current_row->empty(), fmt::ptr(&*current_titer));
+    switch (prefix) {
+      case '*':
+          return DontCare;
+      case '<':
+          return LessThan;
+      case '>':
+          return MoreThan;
+      case '~':
+          return Dodgy;
+      default:
+          throw invalid_titer(fmt::format("unrecognized titer prefix '{}'", prefix));
     }
 
-} // ae::chart::v3::Titers::iterator::data_sparse::skip_empty_rows
+} // ae::chart::v3::Titer::type_of_prefix
 
 // ----------------------------------------------------------------------
 
-std::string_view ae::chart::v3::Titer::validate(std::string_view titer)
+uint32_t ae::chart::v3::Titer::parse(std::string_view titer)
 {
     if (titer.empty())
         throw invalid_titer(titer);
 
-    const auto just_digits = [titer](auto&& data) {
-        if (!std::all_of(std::begin(data), std::end(data), [](auto val) { return std::isdigit(val); }))
-            throw invalid_titer(titer);
-    };
-
+    Type typ{Regular};
+    auto digits = titer;
     switch (titer.front()) {
       case '*':
           if (titer.size() != 1)
               throw invalid_titer(titer);
-          break;
+          return encode(DontCare, 0);
       case '<':
       case '>':
       case '~':
-          just_digits(titer.substr(1));
+          typ = type_of_prefix(titer.front());
+          digits.remove_prefix(1);
           break;
       default:
-          just_digits(titer);
           break;
     }
-    return titer;
 
-} // ae::chart::v3::Titer::validate
+    if (digits.empty() || !std::all_of(std::begin(digits), std::end(digits), [](auto val) { return std::isdigit(val); }))
+        throw invalid_titer(titer);
+    size_t value{0};
+    if (const auto [end, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), value); ec != std::errc{} || value > value_mask)
+        throw invalid_titer(titer);
+    return encode(typ, value);
+
+} // ae::chart::v3::Titer::parse
+
+// ----------------------------------------------------------------------
+
+char ae::chart::v3::Titer::prefix() const
+{
+    switch (type()) {
+      case DontCare:
+          return '*';
+      case LessThan:
+          return '<';
+      case MoreThan:
+          return '>';
+      case Dodgy:
+          return '~';
+      case Invalid:
+      case Regular:
+          return 0;
+    }
+    return 0;
+
+} // ae::chart::v3::Titer::prefix
+
+// ----------------------------------------------------------------------
+
+std::string ae::chart::v3::Titer::get() const
+{
+    return fmt::format("{}", *this);
+
+} // ae::chart::v3::Titer::get
 
 // ----------------------------------------------------------------------
 
@@ -88,7 +104,7 @@ double ae::chart::v3::Titer::logged_with_thresholded() const
       case MoreThan:
           return logged() + 1;
     }
-    throw invalid_titer(*this); // for gcc 7.2
+    throw invalid_titer(get()); // for gcc 7.2
 
 } // ae::chart::v3::Titer::logged_with_thresholded
 
@@ -98,17 +114,17 @@ std::string ae::chart::v3::Titer::logged_as_string() const
 {
     switch (type()) {
       case Invalid:
-          throw invalid_titer(*this);
+          throw invalid_titer(get());
       case Regular:
           return fmt::format("{}", logged());
       case DontCare:
-          return std::string{get()};
+          return get();
       case LessThan:
       case MoreThan:
       case Dodgy:
-          return fmt::format("{}{}", get().front(), logged());
+          return fmt::format("{}{}", prefix(), logged());
     }
-    throw invalid_titer(*this); // for gcc 7.2
+    throw invalid_titer(get()); // for gcc 7.2
 
 } // ae::chart::v3::Titer::logged_as_string
 
@@ -118,7 +134,7 @@ double ae::chart::v3::Titer::logged_for_column_bases() const
 {
     switch (type()) {
       case Invalid:
-          throw invalid_titer(*this);
+          throw invalid_titer(get());
       case Regular:
       case LessThan:
           return logged();
@@ -128,7 +144,7 @@ double ae::chart::v3::Titer::logged_for_column_bases() const
       case Dodgy:
           return -1;
     }
-    throw invalid_titer(*this); // for gcc 7.2
+    throw invalid_titer(get()); // for gcc 7.2
 
 } // ae::chart::v3::Titer::logged_for_column_bases
 
@@ -141,13 +157,13 @@ size_t ae::chart::v3::Titer::value_for_sorting() const
       case DontCare:
           return 0;
       case Regular:
-          return from_chars<size_t>(get());
+          return value();
       case LessThan:
-          return from_chars<size_t>(get().substr(1)) - 1;
+          return value() - 1;
       case MoreThan:
-          return from_chars<size_t>(get().substr(1)) + 1;
+          return value() + 1;
       case Dodgy:
-          return from_chars<size_t>(get().substr(1));
+          return value();
     }
     return 0;
 
@@ -155,25 +171,6 @@ size_t ae::chart::v3::Titer::value_for_sorting() const
 
 // ----------------------------------------------------------------------
 
-size_t ae::chart::v3::Titer::value() const
-{
-    switch (type()) {
-      case Invalid:
-      case DontCare:
-          return 0;
-      case Regular:
-          return from_chars<size_t>(get());
-      case LessThan:
-      case MoreThan:
-      case Dodgy:
-          return from_chars<size_t>(get().substr(1));
-    }
-    return 0;
-
-} // ae::chart::v3::Titer::value
-
-// ----------------------------------------------------------------------
-
 size_t ae::chart::v3::Titer::value_with_thresholded() const
 {
     switch (type()) {
@@ -181,13 +178,13 @@ size_t ae::chart::v3::Titer::value_with_thresholded() const
       case DontCare:
           return 0;
       case Regular:
-          return from_chars<size_t>(get());
+          return value();
       case LessThan:
-          return from_chars<size_t>(get().substr(1)) / 2;
+          return value() / 2;
       case MoreThan:
-          return from_chars<size_t>(get().substr(1)) * 2;
+          return value() * 2;
       case Dodgy:
-          return from_chars<size_t>(get().substr(1));
+          return value();
     }
     return 0;
 
@@ -202,11 +199,10 @@ ae::chart::v3::Titer ae::chart::v3::Titer::multiplied_by(double value) const //
       case DontCare:
           return *this;
       case Regular:
-          return Titer{fmt::format("{}", std::lround(static_cast<double>(std::stoul(get())) * value))};
       case LessThan:
       case MoreThan:
       case Dodgy:
-          return Titer{fmt::format("{}{}", get().front(), std::lround(static_cast<double>(std::stoul(get().substr(1))) * value))};
+          return Titer{type(), static_cast<size_t>(std::lround(static_cast<double>(this->value()) * value))};
     }
     return Titer{};
 
@@ -214,6 +210,209 @@ ae::chart::v3::Titer ae::chart::v3::Titer::multiplied_by(double value) const //
 
 // ----------------------------------------------------------------------
 
+void ae::chart::v3::sparse_titers_t::set(antigen_index ag_no, serum_index sr_no, const Titer& titer)
+{
+    const auto first = std::next(sera_.begin(), static_cast<ssize_t>(row_offsets_[*ag_no])), last = std::next(sera_.begin(), static_cast<ssize_t>(row_offsets_[*ag_no + 1]));
+    const auto found = std::lower_bound(first, last, sr_no);
+    const auto pos = found - sera_.begin();
+    const bool present = found != last && *found == sr_no;
+    if (titer.is_dont_care()) {
+        if (present) {
+            sera_.erase(found);
+            titers_.erase(std::next(titers_.begin(), pos));
+            std::for_each(std::next(row_offsets_.begin(), static_cast<ssize_t>(*ag_no + 1)), row_offsets_.end(), [](auto& offset) { --offset; });
+        }
+    }
+    else if (present) {
+        titers_[static_cast<size_t>(pos)] = titer;
+    }
+    else {
+        sera_.insert(found, sr_no);
+        titers_.insert(std::next(titers_.begin(), pos), titer);
+        std::for_each(std::next(row_offsets_.begin(), static_cast<ssize_t>(*ag_no + 1)), row_offsets_.end(), [](auto& offset) { ++offset; });
+    }
+
+} // ae::chart::v3::sparse_titers_t::set
+
+// ----------------------------------------------------------------------
+
+void ae::chart::v3::sparse_titers_t::remove_antigens(const antigen_indexes& to_remove)
+{
+    std::vector<bool> remove(size(), false);
+    for (const auto ag_no : to_remove)
+        remove[*ag_no] = true;
+
+    std::vector<size_t> row_offsets(1, 0);
+    row_offsets.reserve(row_offsets_.size());
+    size_t target{0};
+    for (size_t ag_no = 0; ag_no < size(); ++ag_no) {
+        if (!remove[ag_no]) {
+            for (auto src = row_offsets_[ag_no]; src < row_offsets_[ag_no + 1]; ++src, ++target) {
+                sera_[target] = sera_[src];
+                titers_[target] = titers_[src];
+            }
+            row_offsets.push_back(target);
+        }
+    }
+    row_offsets_ = std::move(row_offsets);
+    sera_.resize(target);
+    titers_.resize(target);
+
+} // ae::chart::v3::sparse_titers_t::remove_antigens
+
+// ----------------------------------------------------------------------
+
+void ae::chart::v3::sparse_titers_t::remove_sera(const serum_indexes& to_remove)
+{
+    auto removed = to_vector_base_t(to_remove);
+    std::sort(removed.begin(), removed.end());
+
+    size_t target{0}, row_begin{0};
+    for (size_t ag_no = 0; ag_no < size(); ++ag_no) {
+        const auto row_end = row_offsets_[ag_no + 1];
+        for (auto src = row_begin; src < row_end; ++src) {
+            // renumber entries: serum index is decreased by the number of removed sera before it
+            if (const auto found = std::lower_bound(removed.begin(), removed.end(), *sera_[src]); found == removed.end() || *found != *sera_[src]) {
+                sera_[target] = sera_[src] - static_cast<size_t>(found - removed.begin());
+                titers_[target] = titers_[src];
+                ++target;
+            }
+        }
+        row_begin = row_end;
+        row_offsets_[ag_no + 1] = target;
+    }
+    sera_.resize(target);
+    titers_.resize(target);
+
+} // ae::chart::v3::sparse_titers_t::remove_sera
+
+// ----------------------------------------------------------------------
+
+ae::chart::v3::sparse_titers_t ae::chart::v3::sparse_titers_builder_t::build()
+{
+    if (!ordered_)
+        std::stable_sort(entries_.begin(), entries_.end(), [](const auto& e1, const auto& e2) { return e1.antigen == e2.antigen ? e1.serum < e2.serum : e1.antigen < e2.antigen; });
+
+    sparse_titers_t result{number_of_antigens_};
+    result.sera_.reserve(entries_.size());
+    result.titers_.reserve(entries_.size());
+    for (auto en = entries_.begin(); en != entries_.end(); ++en) {
+        if (const auto next = std::next(en); next != entries_.end() && next->antigen == en->antigen && next->serum == en->serum)
+            continue; // the same cell added later, use the last one
+        if (en->antigen >= number_of_antigens_)
+            throw std::out_of_range{fmt::format("sparse_titers_builder_t: invalid antigen index {}, number of antigens: {}", en->antigen, number_of_antigens_)};
+        if (!en->titer.is_dont_care()) {
+            result.sera_.push_back(en->serum);
+            result.titers_.push_back(en->titer);
+            ++result.row_offsets_[*en->antigen + 1];
+        }
+    }
+    std::partial_sum(result.row_offsets_.begin(), result.row_offsets_.end(), result.row_offsets_.begin());
+    entries_.clear();
+    ordered_ = true;
+    return result;
+
+} // ae::chart::v3::sparse_titers_builder_t::build
+
+// ----------------------------------------------------------------------
+
+void ae::chart::v3::titer_columns_t::allocate(serum_index number_of_sera, size_t number_of_entries)
+{
+    // column_offsets_ contains number of entries of each column shifted by one, convert into offsets
+    column_offsets_.resize(*number_of_sera + 1, 0);
+    std::partial_sum(column_offsets_.begin(), column_offsets_.end(), column_offsets_.begin());
+    antigens_.resize(number_of_entries);
+    titers_.resize(number_of_entries);
+
+} // ae::chart::v3::titer_columns_t::allocate
+
+// ----------------------------------------------------------------------
+
+ae::chart::v3::titer_columns_t::titer_columns_t(const sparse_titers_t& rows, serum_index number_of_sera)
+    : column_offsets_(*number_of_sera + 1, 0)
+{
+    for (const auto sr_no : rows.sera())
+        ++column_offsets_[*sr_no + 1];
+    allocate(number_of_sera, rows.number_of_entries());
+
+    // rows are visited in order, columns become ordered by antigen
+    std::vector<size_t> next(column_offsets_.begin(), std::prev(column_offsets_.end()));
+    for (size_t ag_no = 0; ag_no < rows.size(); ++ag_no) {
+        for (const auto& [sr_no, titer] : rows[ag_no]) {
+            const auto pos = next[*sr_no]++;
+            antigens_[pos] = antigen_index{ag_no};
+            titers_[pos] = titer;
+        }
+    }
+
+} // ae::chart::v3::titer_columns_t::titer_columns_t
+
+// ----------------------------------------------------------------------
+
+ae::chart::v3::titer_columns_t::titer_columns_t(std::span<const Titer> dense, serum_index number_of_sera)
+    : column_offsets_(*number_of_sera + 1, 0)
+{
+    if (number_of_sera == serum_index{0})
+        return;
+    const auto number_of_antigens = dense.size() / *number_of_sera;
+    size_t number_of_entries{0};
+    for (size_t cell = 0; cell < dense.size(); ++cell) {
+        if (!dense[cell].is_dont_care()) {
+            ++column_offsets_[cell % *number_of_sera + 1];
+            ++number_of_entries;
+        }
+    }
+    allocate(number_of_sera, number_of_entries);
+
+    std::vector<size_t> next(column_offsets_.begin(), std::prev(column_offsets_.end()));
+    for (size_t ag_no = 0; ag_no < number_of_antigens; ++ag_no) {
+        for (size_t sr_no = 0; sr_no < *number_of_sera; ++sr_no) {
+            if (const auto& titer = dense[ag_no * *number_of_sera + sr_no]; !titer.is_dont_care()) {
+                const auto pos = next[sr_no]++;
+                antigens_[pos] = antigen_index{ag_no};
+                titers_[pos] = titer;
+            }
+        }
+    }
+
+} // ae::chart::v3::titer_columns_t::titer_columns_t
+
+// ----------------------------------------------------------------------
+
+void ae::chart::v3::Titers::build_column_index()
+{
+    columns_.enabled = true;
+    columns();
+
+} // ae::chart::v3::Titers::build_column_index
+
+// ----------------------------------------------------------------------
+
+void ae::chart::v3::Titers::drop_column_index()
+{
+    std::lock_guard<std::mutex> lock{columns_.access};
+    columns_.enabled = false;
+    columns_.data.reset();
+
+} // ae::chart::v3::Titers::drop_column_index
+
+// ----------------------------------------------------------------------
+
+const ae::chart::v3::titer_columns_t* ae::chart::v3::Titers::columns() const
+{
+    if (!columns_.enabled)
+        return nullptr;
+    std::lock_guard<std::mutex> lock{columns_.access};
+    if (!columns_.data.has_value() || columns_.version != version_) {
+        std::visit([this](const auto& titers) { columns_.data.emplace(titers, number_of_sera_); }, titers_);
+        columns_.version = version_;
+    }
+    return &*columns_.data;
+
+} // ae::chart::v3::Titers::columns
+
+// ----------------------------------------------------------------------
+
 ae::chart::v3::Titer ae::chart::v3::Titers::titer(antigen_index aAntigenNo, serum_index aSerumNo) const
 {
     auto get = [this,aAntigenNo,aSerumNo](const auto& titers) -> Titer {
@@ -221,7 +420,7 @@ ae::chart::v3::Titer ae::chart::v3::Titers::titer(antigen_index aAntigenNo, seru
         if constexpr (std::is_same_v<T, dense_t>)
             return titers[aAntigenNo.get() * this->number_of_sera_.get() + aSerumNo.get()];
         else
-            return titer_in_sparse_t(titers, aAntigenNo, aSerumNo);
+            return titers.find(aAntigenNo, aSerumNo);
     };
     return std::visit(get, titers_);
 
@@ -231,7 +430,8 @@ ae::chart::v3::Titer ae::chart::v3::Titers::titer(antigen_index aAntigenNo, seru
 
 void ae::chart::v3::Titers::create_layers(layer_index num_layers, antigen_index num_antigens)
 {
-    layers_.resize(*num_layers, sparse_t(*num_antigens));
+    layers_.resize(*num_layers, sparse_t(num_antigens));
+    ++version_;
 
 } // ae::chart::v3::Titers::create_layers
 
@@ -242,7 +442,7 @@ std::vector<ae::chart::v3::Titer> ae::chart::v3::Titers::titers_for_layers(antig
     check_layers();
     std::vector<Titer> result;
     for (const auto& layer: layers_) {
-        if (const auto titer = find_titer_for_serum(layer[aAntigenNo.get()], aSerumNo); !titer.is_dont_care())
+        if (const auto titer = layer.find(aAntigenNo, aSerumNo); !titer.is_dont_care())
             result.push_back(titer);
         else if (inc == include_dotcare::yes)
             result.push_back({});
@@ -258,13 +458,8 @@ ae::layer_indexes ae::chart::v3::Titers::layers_with_antigen(antigen_index aAnti
     check_layers();
     layer_indexes result;
     for (const auto no : number_of_layers()) {
-        const auto& layer = this->layer(no);
-        for (const auto serum_no : number_of_sera()) {
-            if (const auto titer = find_titer_for_serum(layer[aAntigenNo.get()], serum_no); !titer.is_dont_care()) {
-                result.push_back(no);
-                break;
-            }
-        }
+        if (!layer(no)[*aAntigenNo].empty()) // dont-care titers are not stored in layers
+            result.push_back(no);
     }
     return result;
 
@@ -277,14 +472,8 @@ ae::layer_indexes ae::chart::v3::Titers::layers_with_serum(serum_index aSerumNo)
     check_layers();
     layer_indexes result;
     for (const auto no : number_of_layers()) {
-        const auto& layer = this->layer(no);
-        for (auto antigen_no : number_of_antigens()) {
-            // AD_DEBUG("{} {:3d} {}", no, antigen_no, layer[antigen_no.get()]);
-            if (const auto titer = find_titer_for_serum(layer[antigen_no.get()], aSerumNo); !titer.is_dont_care()) {
-                result.push_back(no);
-                break;
-            }
-        }
+        if (const auto& sera = layer(no).sera(); std::find(sera.begin(), sera.end(), aSerumNo) != sera.end()) // dont-care titers are not stored in layers
+            result.push_back(no);
     }
     return result;
 
@@ -313,7 +502,7 @@ size_t ae::chart::v3::Titers::number_of_non_dont_cares() const
         if constexpr (std::is_same_v<T, dense_t>)
             return std::accumulate(titers.begin(), titers.end(), size_t{0}, [](size_t a, const auto& titer) -> size_t { return a + (titer.is_dont_care() ? size_t{0} : size_t{1}); });
         else
-            return std::accumulate(titers.begin(), titers.end(), size_t{0}, [](size_t a, const auto& row) -> size_t { return a + row.size(); });
+            return titers.number_of_entries();
     };
     return std::visit(num_non_dont_cares, titers_);
 
@@ -339,27 +528,9 @@ size_t ae::chart::v3::Titers::titrations_for_antigen(antigen_index antigen_no) c
 
 size_t ae::chart::v3::Titers::titrations_for_serum(serum_index serum_no) const
 {
-    auto num_non_dont_cares = [serum_no, this](const auto& titers) -> size_t {
-        using T = std::decay_t<decltype(titers)>;
-        size_t result{0};
-        if constexpr (std::is_same_v<T, dense_t>) {
-            for (auto antigen_no = 0ul; antigen_no < (titers.size() / this->number_of_sera_.get()); ++antigen_no) {
-                if (!titers[antigen_no * this->number_of_sera_.get() + serum_no.get()].is_dont_care())
-                    ++result;
-            }
-        }
-        else {
-            for (auto& row : titers) {
-                if (auto found = std::lower_bound(row.begin(), row.end(), serum_no, [](const auto& e1, auto sr_no) { return e1.first < sr_no; });
-                    found != row.end() && found->first == serum_no) {
-                    if (!found->second.is_dont_care())
-                        ++result;
-                }
-            }
-        }
-        return result;
-    };
-    return std::visit(num_non_dont_cares, titers_);
+    if (const auto* columns = this->columns(); columns)
+        return (*columns)[*serum_no].size();
+    return statistics([this, serum_no](const statistics_t& stat) { return stat.titrations[*number_of_antigens() + *serum_no]; });
 
 } // ae::chart::v3::Titers::titrations_for_serum
 
@@ -434,9 +605,15 @@ ae::point_indexes ae::chart::v3::Titers::having_titers_with(point_index point_no
     }
     else {
         const auto serum_no = point_no.get() - number_of_antigens().get();
-        for (const auto titer_ref : titers_existing()) {
-            if (titer_ref.serum.get() == serum_no)
-                result.push_back(point_index{titer_ref.antigen});
+        if (const auto* columns = this->columns(); columns) {
+            for (const auto ag_no : (*columns)[serum_no].antigens())
+                result.push_back(point_index{ag_no});
+        }
+        else {
+            for (const auto titer_ref : titers_existing()) {
+                if (titer_ref.serum.get() == serum_no)
+                    result.push_back(point_index{titer_ref.antigen});
+            }
         }
     }
     return result;
@@ -447,53 +624,20 @@ ae::point_indexes ae::chart::v3::Titers::having_titers_with(point_index point_no
 
 ae::point_indexes ae::chart::v3::Titers::having_too_few_numeric_titers(size_t threshold) const
 {
-    std::vector<size_t> number_of_numeric_titers(*(number_of_antigens() + number_of_sera()), 0);
-    for (const auto titer_ref : titers_existing()) {
-        if (titer_ref.titer.is_regular()) {
-            ++number_of_numeric_titers[*titer_ref.antigen];
-            ++number_of_numeric_titers[*(number_of_antigens() + titer_ref.serum)];
+    return statistics([threshold](const statistics_t& stat) {
+        const auto& number_of_numeric_titers = stat.numeric_titers;
+        point_indexes result;
+        for (auto ind = number_of_numeric_titers.begin(); ind != number_of_numeric_titers.end(); ++ind) {
+            if (*ind < threshold)
+                result.push_back(point_index{ind - number_of_numeric_titers.begin()});
         }
-    }
-    point_indexes result;
-    for (auto ind = number_of_numeric_titers.begin(); ind != number_of_numeric_titers.end(); ++ind) {
-        if (*ind < threshold)
-            result.push_back(point_index{ind - number_of_numeric_titers.begin()});
-    }
-    return result;
+        return result;
+    });
 
 } // ae::chart::v3::Titers::having_too_few_numeric_titers
 
 // ----------------------------------------------------------------------
 
-ae::chart::v3::Titer ae::chart::v3::Titers::find_titer_for_serum(const sparse_row_t& aRow, serum_index aSerumNo)
-{
-    if (aRow.empty())
-        return {};
-    if (const auto found = std::lower_bound(aRow.begin(), aRow.end(), aSerumNo, [](const auto& e1, serum_index sr_no) { return e1.first < sr_no; }); found != aRow.end() && found->first == aSerumNo)
-        return found->second;
-    return {};
-
-} // ae::chart::v3::Titers::find_titer_for_serum
-
-// ----------------------------------------------------------------------
-
-void ae::chart::v3::Titers::set_titer(sparse_t& titers, antigen_index aAntigenNo, serum_index aSerumNo, const Titer& aTiter)
-{
-    auto& row = titers[aAntigenNo.get()];
-    if (row.empty()) {
-        row.emplace_back(aSerumNo, aTiter);
-    }
-    else {
-        if (auto found = std::lower_bound(row.begin(), row.end(), aSerumNo, [](const auto& e1, serum_index sr_no) { return e1.first < sr_no; }); found != row.end() && found->first == aSerumNo)
-            found->second = aTiter;
-        else
-            row.emplace(found, aSerumNo, aTiter);
-    }
-
-} // ae::chart::v3::Titers::set_titer
-
-// ----------------------------------------------------------------------
-
 // if there are more-than thresholded titers and more_than_thresholded
 // is 'dont-care', ignore them, if more_than_thresholded is
 // 'adjust-to-next', those titers are converted to the next value,
@@ -504,34 +648,72 @@ ae::chart::v3::Titers::titer_merge_report ae::chart::v3::Titers::set_titers_from
     // backend/antigenic-table.hh:892
 
     const titer_merge_report merge_report = set_from_layers_report(mtt);
-    const antigen_index number_of_antigens{layers_[0].size()};
-
-    if (merge_report.size() < (number_of_antigens.get() * number_of_sera_.get() / 2))
-        titers_ = sparse_t(number_of_antigens.get());
-    else
-        titers_ = dense_t(number_of_antigens.get() * number_of_sera_.get());
-    for (const auto& data : merge_report) {
-        if (!data.titer.is_dont_care())
-            std::visit([&data, this](auto& target) { this->set_titer(target, data.antigen, data.serum, data.titer); }, titers_);
-    }
+    sparse_titers_builder_t builder{antigen_index{layers_[0].size()}};
+    builder.reserve(merge_report.size());
+    for (const auto& data : merge_report)
+        builder.add(data.antigen, data.serum, data.titer); // dont-cares are not stored
+    set_merged_titers(builder.build());
 
+    ++version_;
     return merge_report;
 
 } // ae::chart::v3::Titers::set_titers_from_layers
 
 // ----------------------------------------------------------------------
 
+void ae::chart::v3::Titers::set_merged_titers(sparse_t&& merged)
+{
+    // report has entries for all cells, choose storage by the number of titers actually merged
+    if (merged.number_of_entries() < (merged.size() * number_of_sera_.get() / 2)) {
+        titers_ = std::move(merged);
+    }
+    else {
+        auto& dense = titers_.emplace<dense_t>(merged.size() * number_of_sera_.get());
+        for (size_t ag_no = 0; ag_no < merged.size(); ++ag_no) {
+            for (const auto [sr_no, titer] : merged[ag_no])
+                set_titer(dense, antigen_index{ag_no}, sr_no, titer);
+        }
+    }
+
+} // ae::chart::v3::Titers::set_merged_titers
+
+// ----------------------------------------------------------------------
+
 ae::chart::v3::Titers::titer_merge_report ae::chart::v3::Titers::set_from_layers_report(more_than_thresholded mtt) const
+{
+    return set_from_layers_report(mtt, index_range(antigen_index{layers_[0].size()}));
+
+} // ae::chart::v3::Titers::set_from_layers_report
+
+// ----------------------------------------------------------------------
+
+ae::chart::v3::Titers::titer_merge_report ae::chart::v3::Titers::set_from_layers_report(more_than_thresholded mtt, const antigen_indexes& antigens) const
 {
     constexpr double standard_deviation_threshold = 1.0; // lispmds: average-multiples-unless-sd-gt-1-ignore-thresholded-unless-only-entries-then-min-threshold
-    const antigen_index number_of_antigens{layers_[0].size()};
-    titer_merge_report merge_report;
-    for (const auto ag_no : number_of_antigens) {
-        for (const auto sr_no : number_of_sera_) {
-            auto [titer, report] = titer_from_layers(ag_no, sr_no, mtt, standard_deviation_threshold);
-            merge_report.emplace_back(std::move(titer), ag_no, sr_no, report);
+    const size_t number_of_rows = antigens.size();
+    const size_t number_of_sera = number_of_sera_.get();
+    titer_merge_report merge_report(number_of_rows * number_of_sera);
+
+    // antigen rows are independent, each row is written to its own slice of merge_report
+    std::exception_ptr error;
+#pragma omp parallel default(shared)
+    {
+        std::vector<size_t> serum_offsets(number_of_sera + 1);
+        std::vector<Titer> row_titers;
+#pragma omp for schedule(dynamic, 16)
+        for (size_t row_no = 0; row_no < number_of_rows; ++row_no) {
+            try {
+                titers_from_layers(antigens[row_no], mtt, standard_deviation_threshold, serum_offsets, row_titers, std::span{merge_report}.subspan(row_no * number_of_sera, number_of_sera));
+            }
+            catch (...) {
+#pragma omp critical
+                if (!error)
+                    error = std::current_exception();
+            }
         }
     }
+    if (error)
+        std::rethrow_exception(error);
 
     return merge_report;
 
@@ -566,18 +748,110 @@ ae::chart::v3::Titers::titer_merge_report ae::chart::v3::Titers::set_from_layers
 
 // ----------------------------------------------------------------------
 
-std::pair<ae::chart::v3::Titer, ae::chart::v3::Titers::titer_merge> ae::chart::v3::Titers::titer_from_layers(antigen_index aAntigenNo, serum_index aSerumNo, more_than_thresholded mtt, double standard_deviation_threshold) const
+ae::chart::v3::Titers::titer_merge_report ae::chart::v3::Titers::update_from_layers(Chart& chart, layer_index first_new_layer)
+{
+    if (number_of_layers() < layer_index{2})
+        throw data_not_available{"table has no layers"};
+    if (first_new_layer == layer_index{0} || first_new_layer > number_of_layers())
+        throw data_not_available{fmt::format("invalid first new layer: {}, number of layers: {}", first_new_layer, number_of_layers())};
+    if (has_morethan_in_layers()) // forced column bases depend on all antigens
+        return set_from_layers(chart);
+
+    // antigens having titers in the new layers and antigens added since the merged titers were set
+    const antigen_index number_of_antigens{layers_[0].size()}, old_number_of_antigens{this->number_of_antigens()};
+    std::vector<bool> touched(*number_of_antigens, false);
+    std::fill(std::next(touched.begin(), static_cast<ssize_t>(*std::min(old_number_of_antigens, number_of_antigens))), touched.end(), true);
+    for (auto layer_no = first_new_layer; layer_no < number_of_layers(); ++layer_no) {
+        const auto& layer = layers_[*layer_no];
+        for (size_t ag_no = 0; ag_no < layer.size(); ++ag_no) {
+            if (!layer[ag_no].empty())
+                touched[ag_no] = true;
+        }
+    }
+    antigen_indexes to_update;
+    for (const auto ag_no : number_of_antigens) {
+        if (touched[*ag_no])
+            to_update.push_back(ag_no);
+    }
+
+    const auto old_number_of_sera = number_of_sera_, new_number_of_sera = chart.sera().size();
+    const auto old_number_of_titers = number_of_non_dont_cares();
+    number_of_sera(new_number_of_sera);
+    const titer_merge_report merge_report = set_from_layers_report(more_than_thresholded::to_dont_care, to_update);
+
+    if (is_dense() && old_number_of_antigens == number_of_antigens && old_number_of_sera == new_number_of_sera) {
+        // the same shape, touched rows are overwritten in place
+        auto& dense = std::get<dense_t>(titers_);
+        for (const auto& data : merge_report)
+            set_titer(dense, data.antigen, data.serum, data.titer);
+    }
+    else {
+        // rows are visited in order: merged titers of untouched antigens
+        // are copied (sera added are not in their rows), rows of touched
+        // antigens are taken from the report, no dense table is allocated
+        sparse_titers_builder_t builder{number_of_antigens};
+        builder.reserve(old_number_of_titers + merge_report.size());
+        auto report = merge_report.begin();
+        for (const auto ag_no : number_of_antigens) {
+            if (touched[*ag_no]) {
+                for (; report != merge_report.end() && report->antigen == ag_no; ++report)
+                    builder.add(ag_no, report->serum, report->titer);
+            }
+            else if (const auto* sparse = std::get_if<sparse_t>(&titers_); sparse) {
+                for (const auto [sr_no, titer] : (*sparse)[*ag_no])
+                    builder.add(ag_no, sr_no, titer);
+            }
+            else {
+                const auto& dense = std::get<dense_t>(titers_);
+                for (const auto sr_no : old_number_of_sera) {
+                    if (const auto& titer = dense[*ag_no * *old_number_of_sera + *sr_no]; !titer.is_dont_care())
+                        builder.add(ag_no, sr_no, titer);
+                }
+            }
+        }
+        set_merged_titers(builder.build());
+    }
+
+    ++version_;
+    return merge_report;
+
+} // ae::chart::v3::Titers::update_from_layers
+
+// ----------------------------------------------------------------------
+
+void ae::chart::v3::Titers::titers_from_layers(antigen_index aAntigenNo, more_than_thresholded mtt, double standard_deviation_threshold, std::vector<size_t>& serum_offsets, std::vector<Titer>& row_titers,
+                                              std::span<titer_merge_data> report) const
 {
-    std::vector<Titer> titers;
-    for (const auto layer_no : number_of_layers()) {
-        if (auto titer = titer_in_sparse_t(layers_[layer_no.get()], aAntigenNo, aSerumNo); !titer.is_dont_care()) {
-            titers.emplace_back(std::move(titer));
+    const size_t number_of_sera = report.size();
+
+    // counting sort of the titers of all layers by serum, layers are
+    // visited in order, so titers of each serum keep the layer order
+    std::fill(serum_offsets.begin(), serum_offsets.end(), 0);
+    for (const auto& layer : layers_) {
+        for (const auto sr_no : layer[*aAntigenNo].sera()) {
+            if (*sr_no < number_of_sera)
+                ++serum_offsets[*sr_no + 1];
+        }
+    }
+    std::partial_sum(serum_offsets.begin(), serum_offsets.end(), serum_offsets.begin());
+    row_titers.resize(serum_offsets.back());
+    for (const auto& layer : layers_) {
+        for (const auto& [sr_no, titer] : layer[*aAntigenNo]) {
+            if (*sr_no < number_of_sera)
+                row_titers[serum_offsets[*sr_no]++] = titer;
         }
     }
 
-    return merge_titers(titers, mtt, standard_deviation_threshold);
+    // serum_offsets[sr_no] now points to the end of titers for sr_no, i.e. to the beginning of titers for sr_no + 1
+    size_t first = 0;
+    for (size_t sr_no = 0; sr_no < number_of_sera; ++sr_no) {
+        const std::span<const Titer> titers{row_titers.data() + first, serum_offsets[sr_no] - first};
+        auto [titer, merge] = merge_titers(titers, mtt, standard_deviation_threshold);
+        report[sr_no] = titer_merge_data{std::move(titer), aAntigenNo, serum_index{sr_no}, merge};
+        first = serum_offsets[sr_no];
+    }
 
-} // ae::chart::v3::Titers::titer_from_layers
+} // ae::chart::v3::Titers::titers_from_layers
 
 // ----------------------------------------------------------------------
 
@@ -595,7 +869,7 @@ std::pair<ae::chart::v3::Titer, ae::chart::v3::Titers::titer_merge> ae::chart::v
 
 // backend/antigenic-table.hh:1087
 
-std::pair<ae::chart::v3::Titer, ae::chart::v3::Titers::titer_merge> ae::chart::v3::Titers::merge_titers(const std::vector<Titer>& titers, more_than_thresholded mtt, double standard_deviation_threshold) const
+std::pair<ae::chart::v3::Titer, ae::chart::v3::Titers::titer_merge> ae::chart::v3::Titers::merge_titers(std::span<const Titer> titers, more_than_thresholded mtt, double standard_deviation_threshold) const
 {
     constexpr auto max_limit = std::numeric_limits<decltype(std::declval<Titer>().value())>::max();
     size_t min_less_than = max_limit, min_more_than = max_limit, min_regular = max_limit;
@@ -636,9 +910,7 @@ std::pair<ae::chart::v3::Titer, ae::chart::v3::Titers::titer_merge> ae::chart::v
     }
 
     // compute SD
-    std::vector<double> adjusted_log(titers.size());
-    std::transform(titers.begin(), titers.end(), adjusted_log.begin(), [](const auto& titer) -> double { return titer.logged_with_thresholded(); }); // 4.
-    const auto sd_mean = ae::statistics::standard_deviation(adjusted_log.begin(), adjusted_log.end());
+    const auto sd_mean = ae::statistics::standard_deviation(titers.begin(), titers.end(), [](const auto& titer) -> double { return titer.logged_with_thresholded(); }); // 4.
     if (sd_mean.population_sd() > standard_deviation_threshold)
         return {Titer{}, titer_merge::sd_too_big};        // 5. if SD > 1, result is *
     if (max_less_than == 0 && min_more_than == max_limit) // 6. just regular
@@ -675,12 +947,7 @@ std::pair<ae::chart::v3::Titer, ae::chart::v3::Titers::titer_merge> ae::chart::v
 // raw value, not adjusted by minimum column basis
 double ae::chart::v3::Titers::raw_column_basis(serum_index sr_no) const
 {
-    double cb{0.0};
-    for (const auto titer_ref : titers_existing()) {
-        if (titer_ref.serum == sr_no)
-            cb = std::max(cb, titer_ref.titer.logged_for_column_bases());
-    }
-    return cb;
+    return statistics([sr_no](const statistics_t& stat) { return stat.serum_max_logged[*sr_no]; });
 
 } // ae::chart::v3::Titers::raw_column_basis
 
@@ -688,15 +955,160 @@ double ae::chart::v3::Titers::raw_column_basis(serum_index sr_no) const
 
 ae::chart::v3::column_bases ae::chart::v3::Titers::raw_column_bases() const            // raw values, not adjusted by minimum column basis
 {
-    column_bases cb;
-    for (const auto sr_no : number_of_sera())
-        cb.add(raw_column_basis(sr_no));
-    return cb;
+    return statistics([](const statistics_t& stat) {
+        column_bases cb;
+        for (const auto val : stat.serum_max_logged)
+            cb.add(val);
+        return cb;
+    });
 
 } // ae::chart::v3::Titers::raw_column_bases
 
 // ----------------------------------------------------------------------
 
+double ae::chart::v3::Titers::column_max_logged(serum_index sr_no) const
+{
+    double cb{0.0};
+    if (const auto* columns = this->columns(); columns) {
+        for (const auto& titer : (*columns)[*sr_no].titers())
+            cb = std::max(cb, titer.logged_for_column_bases());
+    }
+    else {
+        for (const auto titer_ref : titers_existing()) {
+            if (titer_ref.serum == sr_no)
+                cb = std::max(cb, titer_ref.titer.logged_for_column_bases());
+        }
+    }
+    return cb;
+
+} // ae::chart::v3::Titers::column_max_logged
+
+// ----------------------------------------------------------------------
+
+const ae::chart::v3::Titers::statistics_t& ae::chart::v3::Titers::valid_statistics() const
+{
+    auto& stat = statistics_.data;
+    if (!statistics_valid()) {
+        const auto number_of_srs = *number_of_sera();
+        const auto number_of_ags = (is_dense() && number_of_srs == 0) ? 0ul : *number_of_antigens();
+        stat.emplace(statistics_t{.version = version_,
+                                  .serum_max_logged = std::vector<double>(number_of_srs, 0.0),
+                                  .titrations = std::vector<size_t>(number_of_ags + number_of_srs, 0),
+                                  .numeric_titers = std::vector<size_t>(number_of_ags + number_of_srs, 0)});
+        for (const auto titer_ref : titers_existing()) {
+            auto& max_logged = stat->serum_max_logged[*titer_ref.serum];
+            max_logged = std::max(max_logged, titer_ref.titer.logged_for_column_bases());
+            ++stat->titrations[*titer_ref.antigen];
+            ++stat->titrations[number_of_ags + *titer_ref.serum];
+            if (titer_ref.titer.is_regular()) {
+                ++stat->numeric_titers[*titer_ref.antigen];
+                ++stat->numeric_titers[number_of_ags + *titer_ref.serum];
+            }
+        }
+    }
+    else {
+        // max of the serum was removed by set_titer() or remove_antigens()
+        for (size_t sr_no = 0; sr_no < stat->serum_max_logged.size(); ++sr_no) {
+            if (std::isnan(stat->serum_max_logged[sr_no]))
+                stat->serum_max_logged[sr_no] = column_max_logged(serum_index{sr_no});
+        }
+    }
+    return *stat;
+
+} // ae::chart::v3::Titers::valid_statistics
+
+// ----------------------------------------------------------------------
+
+void ae::chart::v3::Titers::update_statistics(antigen_index aAntigenNo, serum_index aSerumNo, const Titer& old_titer, const Titer& new_titer)
+{
+    std::lock_guard<std::mutex> lock{statistics_.access};
+    if (statistics_valid()) {
+        auto& stat = *statistics_.data;
+        const auto serum_point = *number_of_antigens() + *aSerumNo;
+        const auto update = [&stat, aAntigenNo, serum_point](const Titer& titer, size_t (*op)(size_t)) {
+            if (!titer.is_dont_care()) {
+                stat.titrations[*aAntigenNo] = op(stat.titrations[*aAntigenNo]);
+                stat.titrations[serum_point] = op(stat.titrations[serum_point]);
+            }
+            if (titer.is_regular()) {
+                stat.numeric_titers[*aAntigenNo] = op(stat.numeric_titers[*aAntigenNo]);
+                stat.numeric_titers[serum_point] = op(stat.numeric_titers[serum_point]);
+            }
+        };
+        update(old_titer, [](size_t val) { return val - 1; });
+        update(new_titer, [](size_t val) { return val + 1; });
+
+        if (auto& max_logged = stat.serum_max_logged[*aSerumNo]; !std::isnan(max_logged)) {
+            if (const auto new_logged = new_titer.logged_for_column_bases(); new_logged >= max_logged)
+                max_logged = new_logged;
+            else if (old_titer.logged_for_column_bases() >= max_logged)
+                max_logged = std::numeric_limits<double>::quiet_NaN(); // max titer replaced with a smaller one
+        }
+        ++stat.version;
+    }
+    ++version_;
+
+} // ae::chart::v3::Titers::update_statistics
+
+// ----------------------------------------------------------------------
+
+void ae::chart::v3::Titers::statistics_remove_antigens(const antigen_indexes& to_remove)
+{
+    std::lock_guard<std::mutex> lock{statistics_.access};
+    if (statistics_valid()) {
+        auto& stat = *statistics_.data;
+        const auto number_of_ags = *number_of_antigens();
+        for (const auto ag_no : to_remove) {
+            for (const auto sr_no : number_of_sera()) {
+                if (const auto titer = this->titer(ag_no, sr_no); !titer.is_dont_care()) {
+                    --stat.titrations[number_of_ags + *sr_no];
+                    if (titer.is_regular())
+                        --stat.numeric_titers[number_of_ags + *sr_no];
+                    if (auto& max_logged = stat.serum_max_logged[*sr_no]; titer.logged_for_column_bases() >= max_logged)
+                        max_logged = std::numeric_limits<double>::quiet_NaN();
+                }
+            }
+        }
+        for (const auto ag_no : to_vector_base_t_descending(to_remove)) {
+            stat.titrations.erase(std::next(stat.titrations.begin(), static_cast<ssize_t>(ag_no)));
+            stat.numeric_titers.erase(std::next(stat.numeric_titers.begin(), static_cast<ssize_t>(ag_no)));
+        }
+        ++stat.version;
+    }
+    ++version_;
+
+} // ae::chart::v3::Titers::statistics_remove_antigens
+
+// ----------------------------------------------------------------------
+
+void ae::chart::v3::Titers::statistics_remove_sera(const serum_indexes& to_remove)
+{
+    std::lock_guard<std::mutex> lock{statistics_.access};
+    if (statistics_valid()) {
+        auto& stat = *statistics_.data;
+        const auto number_of_ags = *number_of_antigens();
+        for (const auto sr_no : to_remove) {
+            for (const auto ag_no : number_of_antigens()) {
+                if (const auto titer = this->titer(ag_no, sr_no); !titer.is_dont_care()) {
+                    --stat.titrations[*ag_no];
+                    if (titer.is_regular())
+                        --stat.numeric_titers[*ag_no];
+                }
+            }
+        }
+        for (const auto sr_no : to_vector_base_t_descending(to_remove)) {
+            stat.serum_max_logged.erase(std::next(stat.serum_max_logged.begin(), static_cast<ssize_t>(sr_no)));
+            stat.titrations.erase(std::next(stat.titrations.begin(), static_cast<ssize_t>(number_of_ags + sr_no)));
+            stat.numeric_titers.erase(std::next(stat.numeric_titers.begin(), static_cast<ssize_t>(number_of_ags + sr_no)));
+        }
+        ++stat.version;
+    }
+    ++version_;
+
+} // ae::chart::v3::Titers::statistics_remove_sera
+
+// ----------------------------------------------------------------------
+
 double ae::chart::v3::Titers::max_distance(const column_bases& cb) const
 {
     double max_distance{0.0};
@@ -727,15 +1139,6 @@ void ae::chart::v3::Titers::remove_antigens(dense_t& data, const antigen_indexes
 
 // ----------------------------------------------------------------------
 
-void ae::chart::v3::Titers::remove_antigens(sparse_t& data, const antigen_indexes& to_remove, serum_index)
-{
-    for (const auto ag_no : to_vector_base_t_descending(to_remove))
-        data.erase(std::next(data.begin(), ag_no));
-
-} // ae::chart::v3::Titers::remove_antigens
-
-// ----------------------------------------------------------------------
-
 void ae::chart::v3::Titers::remove_sera(dense_t& data, const serum_indexes& to_remove, serum_index number_of_sera)
 {
     const auto number_of_antigens = data.size() / number_of_sera.get();
@@ -750,20 +1153,3 @@ void ae::chart::v3::Titers::remove_sera(dense_t& data, const serum_indexes& to_r
 
 // ----------------------------------------------------------------------
 
-void ae::chart::v3::Titers::remove_sera(sparse_t& data, const serum_indexes& to_remove, serum_index)
-{
-    for (auto& ag_en : data) {
-        for (const auto sr_no : to_vector_base_t_descending(to_remove)) {
-            // remove entry for sr_no
-            ag_en.erase(std::remove_if(std::begin(ag_en), std::end(ag_en), [sr_no](const auto& sr_en) { return sr_en.first.get() == sr_no; }), std::end(ag_en));
-            // re-number entries if their no > sr_no
-            for (auto& en : ag_en) {
-                if (en.first.get() > sr_no)
-                    --en.first;
-            }
-        }
-    }
-
-} // ae::chart::v3::Titers::remove_sera
-
-// ----------------------------------------------------------------------
@@ -1,8 +1,13 @@
 #pragma once
 
+#include <cstdint>
+#include <cmath>
 #include <vector>
+#include <span>
 #include <variant>
+#include <optional>
 #include <memory>
+#include <mutex>
 
 #include "utils/named-type.hh"
 #include "chart/v3/index.hh"
@@ -30,47 +35,22 @@ namespace ae::chart::v3
 
     // ----------------------------------------------------------------------
 
-    class Titer : public ae::named_string_t<std::string, struct chart_Titer_tag_t>
+    // Titer is stored encoded in 32 bits: type in the upper 3 bits and
+    // value (e.g. 40 for "<40") in the lower 29 bits. Conversion to/from
+    // string happens at I/O boundaries only (import, export, python).
+    class Titer
     {
       public:
         enum Type { Invalid, Regular, DontCare, LessThan, MoreThan, Dodgy };
 
-        using base_t = ae::named_string_t<std::string, struct chart_Titer_tag_t>;
-
-        Titer() : base_t("*") {}
-        Titer(char typ, size_t value) : base_t(typ + std::to_string(value)) {}
-        Titer(std::string_view source) : base_t(validate(source)) {}
+        Titer() = default;
+        Titer(Type typ, size_t value) : data_{encode(typ, value)} {}
+        Titer(char typ, size_t value) : data_{encode(type_of_prefix(typ), value)} {}
+        Titer(std::string_view source) : data_{parse(source)} {}
         Titer(const Titer&) = default;
         Titer& operator=(const Titer&) = default;
 
-        Type type() const
-        {
-            if (empty())
-                return Invalid;
-            switch (get().front()) {
-                case '*':
-                    return DontCare;
-                case '<':
-                    return LessThan;
-                case '>':
-                    return MoreThan;
-                case '~':
-                    return Dodgy;
-                case '0':
-                case '1':
-                case '2':
-                case '3':
-                case '4':
-                case '5':
-                case '6':
-                case '7':
-                case '8':
-                case '9':
-                    return Regular;
-                default:
-                    return Invalid;
-            }
-        }
+        Type type() const { return static_cast<Type>(data_ >> value_bits); }
 
         bool is_invalid() const { return type() == Invalid; }
         bool is_dont_care() const { return type() == DontCare; }
@@ -78,9 +58,10 @@ namespace ae::chart::v3
         bool is_less_than() const { return type() == LessThan; }
         bool is_more_than() const { return type() == MoreThan; }
 
-        auto operator<=>(const Titer& other) const
+        bool operator==(const Titer&) const = default;
+        std::strong_ordering operator<=>(const Titer& other) const
         {
-            if (ae::named_string_t<std::string, struct chart_Titer_tag_t>::operator==(other))
+            if (data_ == other.data_)
                 return std::strong_ordering::equal;
             else
                 return value_for_sorting() <=> other.value_for_sorting();
@@ -88,39 +69,274 @@ namespace ae::chart::v3
 
         double logged() const
         {
-            const auto log_titer = [](std::string_view source) -> double { return std::log2(std::stod(std::string{source}) / 10.0); };
-
             switch (type()) {
                 case Regular:
-                    return log_titer(*this);
                 case LessThan:
                 case MoreThan:
                 case Dodgy:
-                    return log_titer(get().substr(1));
+                    return std::log2(static_cast<double>(value()) / 10.0);
                 case DontCare:
                 case Invalid:
-                    throw invalid_titer{*this};
+                    throw invalid_titer{get()};
             }
-            throw invalid_titer{*this}; // for g++ 11
+            throw invalid_titer{get()}; // for g++ 11
         }
 
         double logged_with_thresholded() const;
         std::string logged_as_string() const;
         double logged_for_column_bases() const;
-        size_t value() const;
+        size_t value() const { return data_ & value_mask; } // 0 for dont-care
         size_t value_for_sorting() const;
         size_t value_with_thresholded() const;   // returns 20 for <40, 20480 for >10240
         Titer multiplied_by(double value) const; // multiplied_by(2) returns 80 for 40 and <80 for <40, * for *
 
+        std::string get() const; // string representation, e.g. "<40"
+        char prefix() const;     // '<', '>', '~', '*' or 0 for regular
+        uint32_t encoded() const { return data_; } // type and value, e.g. for hashing
+        static Titer from_encoded(uint32_t data)
+        {
+            if ((data >> value_bits) > static_cast<uint32_t>(Dodgy))
+                throw invalid_titer{fmt::format("invalid encoded titer: {:#x}", data)};
+            Titer titer;
+            titer.data_ = data;
+            return titer;
+        }
+
         // static inline Titer from_logged(double aLogged, std::string aPrefix = "") { return aPrefix + std::to_string(std::lround(std::pow(2.0, aLogged) * 10.0)); }
-        static inline Titer from_logged(double aLogged, const char* aPrefix = "") { return Titer{aPrefix + std::to_string(std::lround(std::exp2(aLogged) * 10.0))}; }
+        static inline Titer from_logged(double aLogged, const char* aPrefix = "")
+        {
+            const auto value = static_cast<size_t>(std::lround(std::exp2(aLogged) * 10.0));
+            return aPrefix[0] == 0 ? Titer{Regular, value} : Titer{aPrefix[0], value};
+        }
 
-        static std::string_view validate(std::string_view titer);
+      private:
+        static constexpr uint32_t value_bits = 29;
+        static constexpr uint32_t value_mask = (uint32_t{1} << value_bits) - 1;
+
+        uint32_t data_{static_cast<uint32_t>(DontCare) << value_bits};
+
+        static uint32_t encode(Type typ, size_t value)
+        {
+            if (value > value_mask)
+                throw invalid_titer{fmt::format("value too big: {}", value)};
+            return (static_cast<uint32_t>(typ) << value_bits) | static_cast<uint32_t>(value);
+        }
+
+        static Type type_of_prefix(char prefix);
+        static uint32_t parse(std::string_view source);
 
     }; // class Titer
 
     // ----------------------------------------------------------------------
 
+    // Sparse titer matrix in the compressed sparse row form: entries of
+    // antigen ag_no are at [row_offsets_[ag_no], row_offsets_[ag_no + 1])
+    // in sera_ and titers_, ordered by serum index. Dont-care titers are not
+    // stored.
+    class sparse_titers_t
+    {
+      public:
+        struct entry_t
+        {
+            serum_index serum;
+            Titer titer;
+        };
+
+        class row_t
+        {
+          public:
+            class const_iterator
+            {
+              public:
+                const_iterator(const serum_index* serum, const Titer* titer) : serum_{serum}, titer_{titer} {}
+                bool operator==(const const_iterator& rhs) const { return serum_ == rhs.serum_; }
+                entry_t operator*() const { return entry_t{*serum_, *titer_}; }
+                const_iterator& operator++()
+                {
+                    ++serum_;
+                    ++titer_;
+                    return *this;
+                }
+
+              private:
+                const serum_index* serum_;
+                const Titer* titer_;
+            };
+
+            row_t(std::span<const serum_index> sera, std::span<const Titer> titers) : sera_{sera}, titers_{titers} {}
+
+            size_t size() const { return sera_.size(); }
+            bool empty() const { return sera_.empty(); }
+            const_iterator begin() const { return const_iterator{sera_.data(), titers_.data()}; }
+            const_iterator end() const { return const_iterator{sera_.data() + sera_.size(), titers_.data() + titers_.size()}; }
+            std::span<const serum_index> sera() const { return sera_; }
+            std::span<const Titer> titers() const { return titers_; }
+
+            Titer find(serum_index sr_no) const
+            {
+                if (const auto found = std::lower_bound(sera_.begin(), sera_.end(), sr_no); found != sera_.end() && *found == sr_no)
+                    return titers_[static_cast<size_t>(found - sera_.begin())];
+                return {};
+            }
+
+          private:
+            std::span<const serum_index> sera_;
+            std::span<const Titer> titers_;
+        };
+
+        sparse_titers_t() = default;
+        explicit sparse_titers_t(antigen_index number_of_antigens) : row_offsets_(*number_of_antigens + 1, 0) {}
+        sparse_titers_t(const sparse_titers_t&) = default;
+        sparse_titers_t(sparse_titers_t&&) = default;
+        sparse_titers_t& operator=(const sparse_titers_t&) = default;
+        sparse_titers_t& operator=(sparse_titers_t&&) = default;
+        bool operator==(const sparse_titers_t&) const = default;
+
+        size_t size() const { return row_offsets_.size() - 1; } // number of antigens
+        size_t number_of_entries() const { return sera_.size(); }
+
+        row_t operator[](size_t ag_no) const
+        {
+            const auto first = row_offsets_[ag_no], size = row_offsets_[ag_no + 1] - first;
+            return row_t{std::span{sera_}.subspan(first, size), std::span{titers_}.subspan(first, size)};
+        }
+
+        Titer find(antigen_index ag_no, serum_index sr_no) const { return operator[](*ag_no).find(sr_no); }
+
+        // for sequential scans
+        const std::vector<size_t>& row_offsets() const { return row_offsets_; }
+        const std::vector<serum_index>& sera() const { return sera_; }
+        const std::vector<Titer>& titers() const { return titers_; }
+
+        // replacing a titer is a binary search in its row, inserting or
+        // removing moves the entries after it and adjusts offsets of the
+        // following rows, use sparse_titers_builder_t for bulk data
+        void set(antigen_index ag_no, serum_index sr_no, const Titer& titer); // dont-care titer removes entry
+        void remove_antigens(const antigen_indexes& to_remove);
+        void remove_sera(const serum_indexes& to_remove);
+        // appends empty rows, antigens are not removed
+        void add_antigens(antigen_index number_of_antigens)
+        {
+            if (*number_of_antigens > size())
+                row_offsets_.resize(*number_of_antigens + 1, row_offsets_.back());
+        }
+
+      private:
+        std::vector<size_t> row_offsets_ = std::vector<size_t>(1, 0); // size: number of antigens + 1
+        std::vector<serum_index> sera_{};
+        std::vector<Titer> titers_{};
+
+        friend class sparse_titers_builder_t;
+    };
+
+    // ----------------------------------------------------------------------
+
+    // Collects titers in any order (import, merge) and produces
+    // sparse_titers_t. If the same cell is added more than once, the last
+    // added titer is used.
+    class sparse_titers_builder_t
+    {
+      public:
+        explicit sparse_titers_builder_t(antigen_index number_of_antigens = antigen_index{0}) : number_of_antigens_{number_of_antigens} {}
+
+        antigen_index add_antigen() { return number_of_antigens_++; } // returns index of the new antigen (row)
+        void reserve(size_t number_of_titers) { entries_.reserve(number_of_titers); }
+
+        void add(antigen_index ag_no, serum_index sr_no, const Titer& titer)
+        {
+            if (ordered_ && !entries_.empty())
+                ordered_ = entries_.back().antigen < ag_no || (entries_.back().antigen == ag_no && entries_.back().serum < sr_no);
+            entries_.push_back(entry_t{ag_no, sr_no, titer});
+        }
+
+        sparse_titers_t build();
+
+      private:
+        struct entry_t
+        {
+            antigen_index antigen;
+            serum_index serum;
+            Titer titer;
+        };
+
+        antigen_index number_of_antigens_;
+        std::vector<entry_t> entries_{};
+        bool ordered_{true}; // entries were added in the row-major order, no sorting required
+    };
+
+    // ----------------------------------------------------------------------
+
+    // Transposed (compressed sparse column) index of the titer matrix:
+    // entries of serum sr_no are at [column_offsets_[sr_no],
+    // column_offsets_[sr_no + 1]) in antigens_ and titers_, ordered by
+    // antigen index. Dont-care titers are not stored.
+    class titer_columns_t
+    {
+      public:
+        struct entry_t
+        {
+            antigen_index antigen;
+            Titer titer;
+        };
+
+        class column_t
+        {
+          public:
+            class const_iterator
+            {
+              public:
+                const_iterator(const antigen_index* antigen, const Titer* titer) : antigen_{antigen}, titer_{titer} {}
+                bool operator==(const const_iterator& rhs) const { return antigen_ == rhs.antigen_; }
+                entry_t operator*() const { return entry_t{*antigen_, *titer_}; }
+                const_iterator& operator++()
+                {
+                    ++antigen_;
+                    ++titer_;
+                    return *this;
+                }
+
+              private:
+                const antigen_index* antigen_;
+                const Titer* titer_;
+            };
+
+            column_t(std::span<const antigen_index> antigens, std::span<const Titer> titers) : antigens_{antigens}, titers_{titers} {}
+
+            size_t size() const { return antigens_.size(); }
+            bool empty() const { return antigens_.empty(); }
+            const_iterator begin() const { return const_iterator{antigens_.data(), titers_.data()}; }
+            const_iterator end() const { return const_iterator{antigens_.data() + antigens_.size(), titers_.data() + titers_.size()}; }
+            std::span<const antigen_index> antigens() const { return antigens_; }
+            std::span<const Titer> titers() const { return titers_; }
+
+          private:
+            std::span<const antigen_index> antigens_;
+            std::span<const Titer> titers_;
+        };
+
+        titer_columns_t() = default;
+        titer_columns_t(const sparse_titers_t& rows, serum_index number_of_sera);
+        titer_columns_t(std::span<const Titer> dense, serum_index number_of_sera);
+
+        size_t size() const { return column_offsets_.size() - 1; } // number of sera
+
+        column_t operator[](size_t sr_no) const
+        {
+            const auto first = column_offsets_[sr_no], size = column_offsets_[sr_no + 1] - first;
+            return column_t{std::span{antigens_}.subspan(first, size), std::span{titers_}.subspan(first, size)};
+        }
+
+
+      private:
+        std::vector<size_t> column_offsets_ = std::vector<size_t>(1, 0); // size: number of sera + 1
+        std::vector<antigen_index> antigens_{};
+        std::vector<Titer> titers_{};
+
+        void allocate(serum_index number_of_sera, size_t number_of_entries);
+    };
+
+    // ----------------------------------------------------------------------
+
     class Titers
     {
       public:
@@ -129,9 +345,7 @@ namespace ae::chart::v3
         static constexpr double dense_sparse_boundary = 0.7;
 
         using dense_t = std::vector<Titer>;
-        using sparse_entry_t = std::pair<serum_index, Titer>;
-        using sparse_row_t = std::vector<sparse_entry_t>;
-        using sparse_t = std::vector<sparse_row_t>; // size = number_of_antigens
+        using sparse_t = sparse_titers_t;
         using titers_t = std::variant<dense_t, sparse_t>;
         using layers_t = std::vector<sparse_t>;
 
@@ -151,11 +365,12 @@ namespace ae::chart::v3
 
         struct titer_merge_data
         {
+            titer_merge_data() = default;
             titer_merge_data(Titer&& a_titer, antigen_index ag_no, serum_index sr_no, titer_merge a_report) : titer{std::move(a_titer)}, antigen{ag_no}, serum{sr_no}, report{a_report} {}
-            Titer titer;
-            antigen_index antigen;
-            serum_index serum;
-            titer_merge report;
+            Titer titer{};
+            antigen_index antigen{0};
+            serum_index serum{0};
+            titer_merge report{titer_merge::all_dontcare};
         };
 
         using titer_merge_report = std::vector<titer_merge_data>;
@@ -209,19 +424,29 @@ namespace ae::chart::v3
 
             struct data_sparse
             {
-                sparse_t::const_iterator current_row;
-                const sparse_t::const_iterator begin_rows;
-                const sparse_t::const_iterator end_rows;
-                sparse_row_t::const_iterator current_titer;
-                sparse_row_t::const_iterator end_titers;
+                const sparse_t* titers;
+                size_t antigen_no;
+                size_t entry_no;
 
                 bool operator==(const data_sparse&) const = default;
-                data_sparse& operator++();
-                antigen_index antigen() const { return antigen_index{current_row - begin_rows}; }
-                serum_index serum() const { return current_titer->first; }
-                ref operator*() const { return ref{antigen(), serum(), current_titer->second}; }
 
-                void skip_empty_rows();
+                data_sparse& operator++()
+                {
+                    ++entry_no;
+                    skip_empty_rows();
+                    return *this;
+                }
+
+                // move to the row containing entry_no
+                void skip_empty_rows()
+                {
+                    while (antigen_no < titers->size() && entry_no >= titers->row_offsets()[antigen_no + 1])
+                        ++antigen_no;
+                }
+
+                antigen_index antigen() const { return antigen_index{antigen_no}; }
+                serum_index serum() const { return titers->sera()[entry_no]; }
+                ref operator*() const { return ref{antigen(), serum(), titers->titers()[entry_no]}; }
             };
 
           public:
@@ -252,20 +477,8 @@ namespace ae::chart::v3
           private:
             enum _scroll_to_end { scroll_to_end };
 
-            iterator(const sparse_t& titers, serum_index)
-                : data_{data_sparse{.current_row = titers.begin(), .begin_rows = titers.begin(), .end_rows = titers.end(), .current_titer = titers.front().begin(), .end_titers = titers.front().end()}}
-            {
-                std::visit(
-                    []<typename SD>(SD& dat) {
-                        if constexpr (std::is_same_v<SD, data_sparse>)
-                            dat.skip_empty_rows();
-                    },
-                    data_);
-            }
-            iterator(const sparse_t& titers, serum_index, _scroll_to_end)
-                : data_{data_sparse{.current_row = titers.end(), .begin_rows = titers.begin(), .end_rows = titers.end(), .current_titer = titers.back().end(), .end_titers = titers.back().end()}}
-            {
-            }
+            iterator(const sparse_t& titers, serum_index) : data_{data_sparse{.titers = &titers, .antigen_no = 0, .entry_no = 0}} { std::get<data_sparse>(data_).skip_empty_rows(); }
+            iterator(const sparse_t& titers, serum_index, _scroll_to_end) : data_{data_sparse{.titers = &titers, .antigen_no = titers.size(), .entry_no = titers.number_of_entries()}} {}
 
             iterator(const dense_t& titers, serum_index number_of_sera) : data_{data_dense{number_of_sera, titers.begin(), titers.begin(), titers.end()}} {}
             iterator(const dense_t& titers, serum_index number_of_sera, _scroll_to_end) : data_{data_dense{number_of_sera, titers.end(), titers.begin(), titers.end()}} {}
@@ -284,18 +497,41 @@ namespace ae::chart::v3
 
         Titers& operator=(const Titers&) = default;
         Titers& operator=(Titers&&) = default;
-        bool operator==(const Titers&) const = default;
+        bool operator==(const Titers& rhs) const // column index, version and statistics are derived data, not compared
+        {
+            return number_of_sera_ == rhs.number_of_sera_ && titers_ == rhs.titers_ && layers_ == rhs.layers_ && layer_titer_modified_ == rhs.layer_titer_modified_;
+        }
 
         antigen_index number_of_antigens() const;
         serum_index number_of_sera() const { return number_of_sera_; }
 
         Titer titer(antigen_index aAntigenNo, serum_index aSerumNo) const;
 
+        // sparse table stays sparse, see sparse_titers_t::set() for the
+        // cost, bulk data is better collected by sparse_titers_builder_t
         void set_titer(antigen_index aAntigenNo, serum_index aSerumNo, const Titer& titer)
         {
+            update_statistics(aAntigenNo, aSerumNo, this->titer(aAntigenNo, aSerumNo), titer);
             std::visit([this, aAntigenNo, aSerumNo, &titer](auto& titers) { set_titer(titers, aAntigenNo, aSerumNo, titer); }, titers_);
         }
 
+        // optional transposed index for per-serum access, once built it
+        // becomes stale on any modification of titers (see version()) and
+        // is rebuilt on the next access, i.e. a bulk edit costs one rebuild
+        void build_column_index();
+        void drop_column_index();
+        bool has_column_index() const { return columns_.enabled; }
+        const titer_columns_t& column_index() const
+        {
+            if (const auto* columns = this->columns(); columns)
+                return *columns;
+            throw data_not_available{"titer column index not built"};
+        }
+
+        // incremented on each modification of titers, incl. layers
+        // (non-const access to layers counts as modification)
+        size_t version() const { return version_; }
+
         size_t number_of_non_dont_cares() const;
         size_t titrations_for_antigen(antigen_index antigen_no) const;
         size_t titrations_for_serum(serum_index serum_no) const;
@@ -314,31 +550,49 @@ namespace ae::chart::v3
         point_indexes having_too_few_numeric_titers(size_t threshold = 3) const;
 
         // importing
-        void number_of_sera(serum_index num) { number_of_sera_ = num; }
+        void number_of_sera(serum_index num)
+        {
+            number_of_sera_ = num;
+            ++version_;
+        }
         dense_t& create_dense_titers()
         {
             titers_ = dense_t{};
+            ++version_;
             return std::get<dense_t>(titers_);
         }
         sparse_t& create_sparse_titers()
         {
             titers_ = sparse_t{};
+            ++version_;
             return std::get<sparse_t>(titers_);
         }
 
         // ----------------------------------------------------------------------
 
         layer_index number_of_layers() const { return layer_index{layers_.size()}; }
-        layers_t& layers() { return layers_; }
-        auto& layer(layer_index layer_no) { return layers_[layer_no.get()]; }
+        layers_t& layers()
+        {
+            ++version_;
+            return layers_;
+        }
+        auto& layer(layer_index layer_no)
+        {
+            ++version_;
+            return layers_[layer_no.get()];
+        }
         const auto& layer(layer_index layer_no) const { return layers_[layer_no.get()]; }
         void check_layers(layer_index layer_no = layer_index{0}) const
         {
             if (number_of_layers() <= layer_no)
                 throw data_not_available{"invalid layer number or no layers present"};
         }
-        Titer titer_of_layer(layer_index aLayerNo, antigen_index aAntigenNo, serum_index aSerumNo) const { return titer_in_sparse_t(layers_[aLayerNo.get()], aAntigenNo, aSerumNo); }
-        void set_titer_of_layer(layer_index aLayerNo, antigen_index aAntigenNo, serum_index aSerumNo, const Titer& titer) { set_titer(layers_[aLayerNo.get()], aAntigenNo, aSerumNo, titer); }
+        Titer titer_of_layer(layer_index aLayerNo, antigen_index aAntigenNo, serum_index aSerumNo) const { return layers_[aLayerNo.get()].find(aAntigenNo, aSerumNo); }
+        void set_titer_of_layer(layer_index aLayerNo, antigen_index aAntigenNo, serum_index aSerumNo, const Titer& titer)
+        {
+            set_titer(layers_[aLayerNo.get()], aAntigenNo, aSerumNo, titer);
+            ++version_;
+        }
         std::vector<Titer> titers_for_layers(antigen_index aAntigenNo, serum_index aSerumNo,
                                              include_dotcare inc = include_dotcare::no) const; // returns list of non-dont-care titers in layers, may throw data_not_available
         layer_indexes layers_with_antigen(antigen_index aAntigenNo) const; // returns list of layer indexes that have non-dont-care titers for the antigen, may throw data_not_available
@@ -346,6 +600,14 @@ namespace ae::chart::v3
         template <typename Ind> layer_indexes layers_with(Ind no) const { if constexpr (std::is_same_v<Ind, antigen_index>) return layers_with_antigen(no); else return layers_with_serum(no); }
         void create_layers(layer_index num_layers, antigen_index num_antigens);
         titer_merge_report set_from_layers(Chart& chart);
+        // layers starting with first_new_layer were added (and antigens/sera
+        // possibly appended) after merged titers were set by
+        // set_from_layers(): merged titers are recomputed only for antigens
+        // having titers in the new layers, report contains just these
+        // antigens. Rows of other antigens are kept: dense table of the
+        // same shape is updated in place, otherwise rows are copied into
+        // a new sparse table (dense if most cells have titers)
+        titer_merge_report update_from_layers(Chart& chart, layer_index first_new_layer);
         titer_merge_report set_from_layers_report(more_than_thresholded mtt = more_than_thresholded::to_dont_care) const;
 
         // ----------------------------------------------------------------------
@@ -385,6 +647,7 @@ namespace ae::chart::v3
 
         void remove_antigens(const antigen_indexes& to_remove)
         {
+            statistics_remove_antigens(to_remove);
             std::visit([&to_remove, this](auto& dat) { Titers::remove_antigens(dat, to_remove, number_of_sera_); }, titers_);
             for (auto& layer : layers_)
                 remove_antigens(layer, to_remove, number_of_sera_);
@@ -392,6 +655,7 @@ namespace ae::chart::v3
 
         void remove_sera(const serum_indexes& to_remove)
         {
+            statistics_remove_sera(to_remove);
             std::visit([&to_remove, this](auto& dat) { Titers::remove_sera(dat, to_remove, number_of_sera_); }, titers_);
             for (auto& layer : layers_)
                 remove_sera(layer, to_remove, number_of_sera_);
@@ -405,21 +669,89 @@ namespace ae::chart::v3
         titers_t titers_{};
         layers_t layers_{};
         bool layer_titer_modified_{false}; // force titer recalculation
+        size_t version_{1};
 
-        static Titer find_titer_for_serum(const sparse_row_t& aRow, serum_index aSerumNo);
-        static inline Titer titer_in_sparse_t(const sparse_t& aSparse, antigen_index aAntigenNo, serum_index aSerumNo) { return find_titer_for_serum(aSparse[aAntigenNo.get()], aSerumNo); }
+        // Statistics computed on demand and then updated incrementally by
+        // set_titer() and remove_antigens()/remove_sera(). If version
+        // differs from version_, titers were modified in another way
+        // (e.g. on import) and statistics is recomputed.
+        struct statistics_t
+        {
+            size_t version{0};
+            std::vector<double> serum_max_logged{}; // raw column bases, NaN: recompute for the serum
+            std::vector<size_t> titrations{};       // per point (antigens, then sera): number of non-dont-care titers
+            std::vector<size_t> numeric_titers{};   // per point: number of regular titers
+        };
+
+        // not copied, copy recomputes statistics on demand
+        struct statistics_cache_t
+        {
+            statistics_cache_t() = default;
+            statistics_cache_t(const statistics_cache_t&) {}
+            statistics_cache_t& operator=(const statistics_cache_t&)
+            {
+                data.reset();
+                return *this;
+            }
+
+            std::mutex access{};
+            std::optional<statistics_t> data{};
+        };
+
+        mutable statistics_cache_t statistics_{};
+
+        // statistics cannot be returned by reference, it may be updated
+        // by another thread once the lock is released: extract() is
+        // called under the lock and its result is returned by value
+        template <typename Extract> auto statistics(Extract&& extract) const
+        {
+            std::lock_guard<std::mutex> lock{statistics_.access};
+            return extract(valid_statistics());
+        }
+        const statistics_t& valid_statistics() const; // statistics_.access must be locked
+        bool statistics_valid() const { return statistics_.data.has_value() && statistics_.data->version == version_; }
+        void update_statistics(antigen_index aAntigenNo, serum_index aSerumNo, const Titer& old_titer, const Titer& new_titer);
+        void statistics_remove_antigens(const antigen_indexes& to_remove);
+        void statistics_remove_sera(const serum_indexes& to_remove);
+        double column_max_logged(serum_index sr_no) const;
+
+        // Column index (if enabled) is rebuilt on access when version
+        // differs from version_. Copy is enabled but built on demand.
+        struct column_index_cache_t
+        {
+            column_index_cache_t() = default;
+            column_index_cache_t(const column_index_cache_t& src) : enabled{src.enabled} {}
+            column_index_cache_t& operator=(const column_index_cache_t& src)
+            {
+                enabled = src.enabled;
+                data.reset();
+                return *this;
+            }
+
+            std::mutex access{};
+            bool enabled{false};
+            size_t version{0};
+            std::optional<titer_columns_t> data{};
+        };
+
+        mutable column_index_cache_t columns_{};
+
+        const titer_columns_t* columns() const; // nullptr if column index is not enabled
 
         void set_titer(dense_t& titers, antigen_index aAntigenNo, serum_index aSerumNo, const Titer& aTiter) { titers[aAntigenNo.get() * number_of_sera_.get() + aSerumNo.get()] = aTiter; }
-        void set_titer(sparse_t& titers, antigen_index aAntigenNo, serum_index aSerumNo, const Titer& aTiter);
+        void set_titer(sparse_t& titers, antigen_index aAntigenNo, serum_index aSerumNo, const Titer& aTiter) { titers.set(aAntigenNo, aSerumNo, aTiter); }
 
-        std::pair<Titer, titer_merge> merge_titers(const std::vector<Titer>& titers, more_than_thresholded mtt, double standard_deviation_threshold) const;
+        std::pair<Titer, titer_merge> merge_titers(std::span<const Titer> titers, more_than_thresholded mtt, double standard_deviation_threshold) const;
         titer_merge_report set_titers_from_layers(more_than_thresholded mtt);
-        std::pair<Titer, titer_merge> titer_from_layers(antigen_index aAntigenNo, serum_index aSerumNo, more_than_thresholded mtt, double standard_deviation_threshold) const;
+        void set_merged_titers(sparse_t&& merged); // sparse or dense storage depending on the number of titers
+        titer_merge_report set_from_layers_report(more_than_thresholded mtt, const antigen_indexes& antigens) const;
+        // merges titers of all layers for one antigen, serum_offsets and row_titers are scratch buffers reused between calls, result is written to report (one entry per serum)
+        void titers_from_layers(antigen_index aAntigenNo, more_than_thresholded mtt, double standard_deviation_threshold, std::vector<size_t>& serum_offsets, std::vector<Titer>& row_titers, std::span<titer_merge_data> report) const;
 
         static void remove_antigens(dense_t& data, const antigen_indexes& to_remove, serum_index number_of_sera);
-        static void remove_antigens(sparse_t& data, const antigen_indexes& to_remove, serum_index number_of_sera);
+        static void remove_antigens(sparse_t& data, const antigen_indexes& to_remove, serum_index) { data.remove_antigens(to_remove); }
         static void remove_sera(dense_t& data, const serum_indexes& to_remove, serum_index number_of_sera);
-        static void remove_sera(sparse_t& data, const serum_indexes& to_remove, serum_index number_of_sera);
+        static void remove_sera(sparse_t& data, const serum_indexes& to_remove, serum_index) { data.remove_sera(to_remove); }
 
     }; // class Titers
 
@@ -430,7 +762,22 @@ namespace ae::chart::v3
     template <>
     struct fmt::formatter<ae::chart::v3::Titer> : fmt::formatter<ae::fmt_helper::default_formatter>
     {
-        template <typename FormatCtx> constexpr auto format(const ae::chart::v3::Titer& titer, FormatCtx& ctx) const { return fmt::format_to(ctx.out(), "{}", titer.get()); }
+        template <typename FormatCtx> constexpr auto format(const ae::chart::v3::Titer& titer, FormatCtx& ctx) const
+        {
+            switch (titer.type()) {
+                case ae::chart::v3::Titer::Regular:
+                    return fmt::format_to(ctx.out(), "{}", titer.value());
+                case ae::chart::v3::Titer::DontCare:
+                    return fmt::format_to(ctx.out(), "*");
+                case ae::chart::v3::Titer::LessThan:
+                case ae::chart::v3::Titer::MoreThan:
+                case ae::chart::v3::Titer::Dodgy:
+                    return fmt::format_to(ctx.out(), "{}{}", titer.prefix(), titer.value());
+                case ae::chart::v3::Titer::Invalid:
+                    break;
+            }
+            return ctx.out();
+        }
     };
 
 template <> struct fmt::formatter<ae::chart::v3::Titers::iterator::ref> : fmt::formatter<ae::fmt_helper::default_formatter>
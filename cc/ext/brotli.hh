@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstring>
+#include <algorithm>
 #include <string>
 #include <string_view>
 #include <stdexcept>
@@ -64,6 +65,23 @@ namespace ae::file
             return output;
         }
 
+        void compress_begin(chunk_sink_t sink) override
+        {
+            if (encoder_)
+                BrotliEncoderDestroyInstance(encoder_);
+            encoder_ = BrotliEncoderCreateInstance(nullptr, nullptr, nullptr);
+            sink_ = std::move(sink);
+        }
+
+        void compress_chunk(std::string_view input) override { compress_stream(input, BROTLI_OPERATION_PROCESS); }
+
+        void compress_end() override
+        {
+            compress_stream({}, BROTLI_OPERATION_FINISH);
+            BrotliEncoderDestroyInstance(encoder_);
+            encoder_ = nullptr;
+        }
+
         enum class check_if_compressed { no, yes };
 
         std::string decompress(std::string_view input) override { return decompress_and_check(input, check_if_compressed::no); }
@@ -83,8 +101,12 @@ namespace ae::file
                 result = BrotliDecoderDecompressStream(decoder_, &available_in, &next_in, &available_out, nullptr, nullptr);
                 const uint8_t* next_out = BrotliDecoderTakeOutput(decoder_, &available_out);
                 // fmt::print(">>>> result: {} available_out: {}\n", result, available_out);
-                if (available_out != 0)
+                if (available_out != 0) {
+                    // brotli does not store uncompressed size, grow geometrically keeping room for padding to avoid copying at the end
+                    if (const auto required = output.size() + available_out + padding(); required > output.capacity())
+                        output.reserve(std::max(required, output.capacity() * 2));
                     output.insert(output.end(), next_out, next_out + available_out);
+                }
             }
             BrotliDecoderDestroyInstance(decoder_);
             decoder_ = nullptr;
@@ -100,6 +122,25 @@ namespace ae::file
       private:
         BrotliEncoderState* encoder_{nullptr};
         BrotliDecoderState* decoder_{nullptr};
+        chunk_sink_t sink_{};
+
+        // streaming compression, output produced by the encoder is passed to sink_ without copying
+        void compress_stream(std::string_view input, BrotliEncoderOperation operation)
+        {
+            size_t available_in = input.size();
+            const auto* next_in = reinterpret_cast<const uint8_t*>(input.data());
+            const auto done = [this, &available_in, operation]() {
+                return operation == BROTLI_OPERATION_FINISH ? BrotliEncoderIsFinished(encoder_) : (available_in == 0 && !BrotliEncoderHasMoreOutput(encoder_));
+            };
+            while (!done()) {
+                size_t available_out = 0;
+                if (BrotliEncoderCompressStream(encoder_, operation, &available_in, &next_in, &available_out, nullptr, nullptr) == BROTLI_FALSE)
+                    throw compressor_failed{"brotli compression failed 1"};
+                size_t output_size = 0;
+                if (const auto* output = BrotliEncoderTakeOutput(encoder_, &output_size); output_size != 0)
+                    sink_(std::string_view{reinterpret_cast<const char*>(output), output_size});
+            }
+        }
     };
 
     // ----------------------------------------------------------------------
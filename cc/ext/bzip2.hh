@@ -2,6 +2,7 @@
 
 #include <string>
 #include <string_view>
+#include <cstring>
 #include <bzlib.h>
 
 #include "ext/compressor.hh"
@@ -38,7 +39,32 @@ namespace ae::file
             strm_.opaque = nullptr;
         }
 
-        std::string compress(std::string_view /*input*/) override { throw compressor_failed{"ae::file::bz2_compress not implemented"}; }
+        std::string compress(std::string_view input) override
+        {
+            std::string output;
+            compress_begin([&output](std::string_view chunk) { output.append(chunk); });
+            compress_chunk(input);
+            compress_end();
+            return output;
+        }
+
+        void compress_begin(chunk_sink_t sink) override
+        {
+            if (BZ2_bzCompressInit(&strm_, 9 /* block size 900k */, 0 /*verbosity*/, 0 /* default work factor */) != BZ_OK)
+                throw compressor_failed("bz2 compression failed during initialization");
+            sink_ = std::move(sink);
+            buffer_.resize(bz2_internal::BufSize);
+            strm_.next_out = buffer_.data();
+            strm_.avail_out = static_cast<decltype(strm_.avail_out)>(buffer_.size());
+        }
+
+        void compress_chunk(std::string_view input) override { compress_stream(input, BZ_RUN); }
+
+        void compress_end() override
+        {
+            compress_stream({}, BZ_FINISH);
+            BZ2_bzCompressEnd(&strm_);
+        }
 
         std::string decompress(std::string_view input) override
         {
@@ -81,6 +107,31 @@ namespace ae::file
 
       private:
         bz_stream strm_{};
+        chunk_sink_t sink_{};
+        std::string buffer_{}; // streaming compression output
+
+        // streaming compression, passes buffer_ to sink_ when it is full and at the end of stream
+        void compress_stream(std::string_view input, int action)
+        {
+            strm_.next_in = const_cast<decltype(strm_.next_in)>(input.data());
+            strm_.avail_in = static_cast<decltype(strm_.avail_in)>(input.size());
+            for (;;) {
+                if (action == BZ_RUN && strm_.avail_in == 0) // BZ2_bzCompress reports BZ_PARAM_ERROR if no progress possible
+                    break;
+                const auto r = BZ2_bzCompress(&strm_, action);
+                if (r != BZ_RUN_OK && r != BZ_FINISH_OK && r != BZ_STREAM_END) {
+                    BZ2_bzCompressEnd(&strm_);
+                    throw compressor_failed("bz2 compression failed, code: " + std::to_string(r));
+                }
+                if (strm_.avail_out == 0 || r == BZ_STREAM_END) {
+                    sink_(std::string_view{buffer_.data(), buffer_.size() - strm_.avail_out});
+                    strm_.next_out = buffer_.data();
+                    strm_.avail_out = static_cast<decltype(strm_.avail_out)>(buffer_.size());
+                }
+                if (r == BZ_STREAM_END)
+                    break;
+            }
+        }
     };
 
 } // namespace ae::file
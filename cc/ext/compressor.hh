@@ -1,7 +1,9 @@
 #pragma once
 
 #include <stdexcept>
+#include <string>
 #include <string_view>
+#include <functional>
 
 // ----------------------------------------------------------------------
 
@@ -9,6 +11,9 @@ namespace ae::file
 {
     class compressor_failed : public std::runtime_error { public: using std::runtime_error::runtime_error; };
 
+    // receives data (e.g. compressed output or exported document) chunk by chunk
+    using chunk_sink_t = std::function<void(std::string_view)>;
+
     class Compressor
     {
       public:
@@ -18,6 +23,14 @@ namespace ae::file
         virtual std::string compress(std::string_view input) = 0;
         virtual std::string decompress(std::string_view input) = 0;
 
+        // Streaming compression: compress_begin(), compress_chunk() any
+        // number of times, compress_end(). Compressed output is passed to
+        // sink as soon as the internal buffer is filled, i.e. memory use
+        // does not depend on the input size.
+        virtual void compress_begin(chunk_sink_t /*sink*/) { throw compressor_failed{"streaming compression not implemented"}; }
+        virtual void compress_chunk(std::string_view /*input*/) { throw compressor_failed{"streaming compression not implemented"}; }
+        virtual void compress_end() { throw compressor_failed{"streaming compression not implemented"}; }
+
       protected:
         size_t padding() const { return padding_; }
 
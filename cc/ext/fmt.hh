@@ -37,6 +37,8 @@
 #pragma GCC diagnostic pop
 
 #include <optional>
+#include <array>
+#include <charconv>
 
 // ======================================================================
 
@@ -128,6 +130,18 @@ namespace ae
         else
             return res;
     }
+
+    // Shortest representation that is parsed back into the same double
+    // (std::to_chars), written directly into out. significant_digits > 0:
+    // rounded to that many significant digits. Used for bulk data
+    // (e.g. layouts) where format_double() dominates export time.
+    inline void format_double_to(fmt::memory_buffer& out, double value, int significant_digits = 0)
+    {
+        std::array<char, 32> buffer; // enough for the shortest form and for general format with precision up to 17
+        const auto result = significant_digits > 0 ? std::to_chars(buffer.data(), buffer.data() + buffer.size(), value, std::chars_format::general, std::min(significant_digits, 17))
+                                                   : std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+        out.append(buffer.data(), result.ptr);
+    }
 } // namespace ae
 
 // ----------------------------------------------------------------------
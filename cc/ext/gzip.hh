@@ -3,6 +3,8 @@
 #include <string>
 #include <string_view>
 #include <cstring>
+#include <cstdint>
+#include <algorithm>
 
 #include <zlib.h>
 
@@ -87,6 +89,24 @@ namespace ae::file
             }
         }
 
+        void compress_begin(chunk_sink_t sink) override
+        {
+            if (deflateInit2(&strm_, Z_BEST_COMPRESSION, Z_DEFLATED, 15 | 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+                throw compressor_failed("gzip compression failed during initialization");
+            sink_ = std::move(sink);
+            buffer_.resize(gzip_internal::BufSize);
+            strm_.next_out = reinterpret_cast<decltype(strm_.next_out)>(buffer_.data());
+            strm_.avail_out = static_cast<decltype(strm_.avail_out)>(buffer_.size());
+        }
+
+        void compress_chunk(std::string_view input) override { deflate_chunk(input, Z_NO_FLUSH); }
+
+        void compress_end() override
+        {
+            deflate_chunk({}, Z_FINISH);
+            deflateEnd(&strm_);
+        }
+
         std::string decompress(std::string_view input) override
         {
             strm_.next_in = reinterpret_cast<decltype(strm_.next_in)>(const_cast<char*>(input.data()));
@@ -97,7 +117,8 @@ namespace ae::file
 
             try {
                 std::string output;
-                output.reserve(gzip_internal::BufSize + padding());
+                // gzip trailer keeps uncompressed size of the last member modulo 2^32, use it as a hint to avoid reallocations
+                output.reserve(std::max(size_hint(input), static_cast<size_t>(gzip_internal::BufSize)) + gzip_internal::BufSize + padding());
                 output.resize(gzip_internal::BufSize);
                 ssize_t offset = 0;
                 for (;;) {
@@ -131,6 +152,38 @@ namespace ae::file
 
       private:
         z_stream strm_{};
+        chunk_sink_t sink_{};
+        std::string buffer_{}; // streaming compression output
+
+        // streaming compression, passes buffer_ to sink_ when it is full and at the end of stream
+        void deflate_chunk(std::string_view input, int flush)
+        {
+            strm_.next_in = reinterpret_cast<decltype(strm_.next_in)>(const_cast<char*>(input.data()));
+            strm_.avail_in = static_cast<decltype(strm_.avail_in)>(input.size());
+            for (;;) {
+                const auto res = deflate(&strm_, flush);
+                if (res != Z_OK && res != Z_STREAM_END && res != Z_BUF_ERROR) { // Z_BUF_ERROR: no progress possible, e.g. empty chunk
+                    deflateEnd(&strm_);
+                    throw compressor_failed("gzip compression failed, code: " + std::to_string(res));
+                }
+                const bool output_full = strm_.avail_out == 0;
+                if (output_full || res == Z_STREAM_END) {
+                    sink_(std::string_view{buffer_.data(), buffer_.size() - strm_.avail_out});
+                    strm_.next_out = reinterpret_cast<decltype(strm_.next_out)>(buffer_.data());
+                    strm_.avail_out = static_cast<decltype(strm_.avail_out)>(buffer_.size());
+                }
+                if (res == Z_STREAM_END || (flush == Z_NO_FLUSH && strm_.avail_in == 0 && !output_full))
+                    break;
+            }
+        }
+
+        static size_t size_hint(std::string_view input)
+        {
+            if (input.size() < 18) // header + trailer
+                return 0;
+            const auto* trailer = reinterpret_cast<const uint8_t*>(input.data() + input.size() - 4);
+            return static_cast<size_t>(trailer[0]) | (static_cast<size_t>(trailer[1]) << 8) | (static_cast<size_t>(trailer[2]) << 16) | (static_cast<size_t>(trailer[3]) << 24);
+        }
     };
 
 } // namespace ae::file
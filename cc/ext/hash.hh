@@ -17,11 +17,14 @@
 
 #define XXH_INLINE_ALL
 
+#include <cstdint>
+#include <string_view>
 #include <xxhash.h>
 
 namespace ae::xxhash
 {
     inline auto xxhash32(std::string_view source) { return XXH32(source.data(), source.size(), 0); }
+    inline uint64_t xxhash64(std::string_view source) { return XXH64(source.data(), source.size(), 0); }
 
 } // namespace ae::xxhash
 
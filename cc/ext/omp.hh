@@ -18,6 +18,7 @@
 constexpr inline int omp_get_thread_num() { return 0; }
 constexpr inline int omp_get_num_threads() { return 1; }
 constexpr inline int omp_get_max_threads() { return 1; }
+inline void omp_set_num_threads(int) {}
 
 #endif
 
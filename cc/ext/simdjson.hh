@@ -31,6 +31,8 @@
 
 #pragma GCC diagnostic pop
 
+#include <memory>
+
 #include "ext/fmt.hh"
 #include "utils/file.hh"
 
@@ -43,28 +45,54 @@ namespace ae::simdjson
     class Parser
     {
       public:
-        Parser(const std::filesystem::path& filename)                    //
-            : parser_{},                                                 //
-              json_{file::read(filename, ::simdjson::SIMDJSON_PADDING)}, //
-              doc_{parser_.iterate(json_, json_.size() + ::simdjson::SIMDJSON_PADDING)}
+        // uncompressed file is parsed in place (memory mapped)
+        Parser(const std::filesystem::path& filename)                  //
+            : parser_{},                                               //
+              file_{std::make_unique<file::read_view_t>(filename, ::simdjson::SIMDJSON_PADDING)}, //
+              json_{},                                                 //
+              shared_json_{},                                          //
+              doc_{parser_.iterate(file_->data(), file_->size(), file_->size() + ::simdjson::SIMDJSON_PADDING)}
         {
         }
 
         Parser(std::string_view data)                    //
             : parser_{},                                                 //
+              file_{},                                                   //
               json_{file::decompress_if_necessary(data, ::simdjson::SIMDJSON_PADDING)}, //
+              shared_json_{},                                                           //
               doc_{parser_.iterate(json_, json_.size() + ::simdjson::SIMDJSON_PADDING)}
         {
         }
 
+        // json is already decompressed, its capacity must include SIMDJSON_PADDING
+        Parser(std::shared_ptr<const std::string> json)      //
+            : parser_{},                                     //
+              file_{},                                       //
+              json_{},                                       //
+              shared_json_{std::move(json)},                 //
+              doc_{parser_.iterate(shared_json_->data(), shared_json_->size(), shared_json_->capacity())}
+        {
+        }
+
         constexpr auto& doc() { return doc_; }
+        std::string_view source() const
+        {
+            if (shared_json_)
+                return *shared_json_;
+            else if (file_)
+                return *file_;
+            else
+                return json_;
+        }
 
-        size_t current_location_offset() { return doc_.current_location().value() - json_.data(); }
+        size_t current_location_offset() { return static_cast<size_t>(doc_.current_location().value() - source().data()); }
         std::string_view current_location_snippet(size_t size) { return std::string_view(doc_.current_location().value(), size); }
 
       private:
         ::simdjson::ondemand::parser parser_;
+        std::unique_ptr<const file::read_view_t> file_{};
         std::string json_;
+        std::shared_ptr<const std::string> shared_json_{};
         decltype(parser_.iterate(json_, json_.capacity())) doc_;
     };
 } // namespace ae::simdjson
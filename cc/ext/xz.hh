@@ -1,8 +1,11 @@
 #pragma once
 
 #include <cstring>
+#include <algorithm>
 #include <string>
 #include <string_view>
+#include <optional>
+#include <thread>
 
 #pragma GCC diagnostic push
 #ifdef __clang__
@@ -29,6 +32,8 @@ namespace ae::file
     {
         const unsigned char Signature[] = {0xFD, '7', 'z', 'X', 'Z', 0x00};
         constexpr size_t BufSize = 409600;
+        constexpr size_t MinBlockSize = 4 * 1024 * 1024; // smaller blocks noticeably worsen compression ratio
+        constexpr size_t StreamingBlockSize = 4 * MinBlockSize; // input size is unknown
     }
 
     // ----------------------------------------------------------------------
@@ -42,32 +47,158 @@ namespace ae::file
 
     // ----------------------------------------------------------------------
 
+    struct xz_stream_info
+    {
+        size_t uncompressed_size{0};
+        size_t number_of_blocks{0};
+    };
+
+    // Reads indexes of the (possibly concatenated) xz streams, they are
+    // stored at the end of each stream. Returns nullopt if input is
+    // not a complete xz file.
+    inline std::optional<xz_stream_info> xz_info(std::string_view input)
+    {
+        const auto* data = reinterpret_cast<const uint8_t*>(input.data());
+        xz_stream_info info;
+        for (size_t end = input.size(); end > 0;) {
+            while (end >= 4 && data[end - 1] == 0 && data[end - 2] == 0 && data[end - 3] == 0 && data[end - 4] == 0) // stream padding
+                end -= 4;
+            if (end < LZMA_STREAM_HEADER_SIZE * 2)
+                return std::nullopt;
+            lzma_stream_flags footer;
+            if (lzma_stream_footer_decode(&footer, data + end - LZMA_STREAM_HEADER_SIZE) != LZMA_OK || footer.backward_size > end - LZMA_STREAM_HEADER_SIZE * 2)
+                return std::nullopt;
+            lzma_index* index{nullptr};
+            uint64_t memlimit{UINT64_MAX};
+            size_t in_pos = end - LZMA_STREAM_HEADER_SIZE - footer.backward_size;
+            if (lzma_index_buffer_decode(&index, &memlimit, nullptr, data, &in_pos, end - LZMA_STREAM_HEADER_SIZE) != LZMA_OK)
+                return std::nullopt;
+            info.uncompressed_size += lzma_index_uncompressed_size(index);
+            info.number_of_blocks += lzma_index_block_count(index);
+            const auto stream_size = lzma_index_file_size(index);
+            lzma_index_end(index, nullptr);
+            if (stream_size > end)
+                return std::nullopt;
+            end -= stream_size;
+        }
+        return info;
+    }
+
+    // ----------------------------------------------------------------------
+
     class XZ_Compressor : public Compressor
     {
       public:
-        XZ_Compressor(size_t padding = 0) : Compressor(padding) { strm_ = LZMA_STREAM_INIT; }
+        // preset: 0-9, possibly | LZMA_PRESET_EXTREME
+        // threads: 0 - number of cores, 1 - single threaded encoder (single block)
+        XZ_Compressor(size_t padding = 0, uint32_t preset = 9 | LZMA_PRESET_EXTREME, uint32_t threads = 0) : Compressor(padding), preset_{preset}, threads_{threads} { strm_ = LZMA_STREAM_INIT; }
 
         ~XZ_Compressor() override { lzma_end(&strm_); }
 
+        // Multi-threaded encoder splits input into independent blocks,
+        // they are compressed in parallel and can be decompressed in
+        // parallel as well (see decompress()). Number of threads is
+        // reduced if encoder would use more than a quarter of RAM (preset
+        // 9 needs about 700MiB per thread).
         std::string compress(std::string_view input) override
         {
-            if (lzma_easy_encoder(&strm_, 9 | LZMA_PRESET_EXTREME, LZMA_CHECK_CRC64) != LZMA_OK) {
-                throw compressor_failed("lzma compression failed 1");
-            }
+            init_encoder(input.size());
             return process(input, 0, xz_internal::BufSize);
         }
 
+        void compress_begin(chunk_sink_t sink) override
+        {
+            init_encoder(std::nullopt);
+            sink_ = std::move(sink);
+            buffer_.resize(xz_internal::BufSize);
+            strm_.next_out = reinterpret_cast<uint8_t*>(buffer_.data());
+            strm_.avail_out = buffer_.size();
+        }
+
+        void compress_chunk(std::string_view input) override { code(input, LZMA_RUN); }
+        void compress_end() override { code({}, LZMA_FINISH); }
+
+        // Output is allocated once using the uncompressed size from the
+        // stream indexes (with padding for simdjson), multi-block streams
+        // (written by the multi-threaded encoder) are decoded in parallel
         std::string decompress(std::string_view input) override
         {
+            const auto info = xz_info(input);
+#if LZMA_VERSION >= 50040002 // lzma_stream_decoder_mt is stable since 5.4.0
+            if (info.has_value() && info->number_of_blocks > 1) {
+                lzma_mt mt{};
+                mt.flags = LZMA_TELL_UNSUPPORTED_CHECK | LZMA_CONCATENATED;
+                mt.threads = std::max(1U, std::thread::hardware_concurrency());
+                mt.memlimit_threading = lzma_physmem() / 4; // decoder falls back to single thread if exceeded
+                mt.memlimit_stop = UINT64_MAX;
+                if (lzma_stream_decoder_mt(&strm_, &mt) != LZMA_OK)
+                    throw compressor_failed("lzma decompression failed 1");
+            }
+            else
+#endif
             if (lzma_stream_decoder(&strm_, UINT64_MAX, LZMA_TELL_UNSUPPORTED_CHECK | LZMA_CONCATENATED) != LZMA_OK) {
                 throw compressor_failed("lzma decompression failed 1");
             }
-            const size_t buf_size = input.size() < xz_internal::BufSize ? xz_internal::BufSize : input.size() * 100;
-            return process(input, padding(), buf_size);
+            return decode(input, info.has_value() ? info->uncompressed_size : std::max(xz_internal::BufSize, input.size() * 8));
         }
 
       private:
         lzma_stream strm_{};
+        uint32_t preset_;
+        uint32_t threads_;
+        chunk_sink_t sink_{};
+        std::string buffer_{}; // streaming compression output
+
+        // input_size is unknown for streaming compression
+        void init_encoder(std::optional<size_t> input_size)
+        {
+            const auto threads = threads_ == 0 ? std::max(1U, std::thread::hardware_concurrency()) : threads_;
+#if LZMA_VERSION >= 50020002 // lzma_stream_encoder_mt is stable since 5.2.0
+            if (threads > 1 && input_size.value_or(SIZE_MAX) > xz_internal::MinBlockSize) {
+                lzma_mt mt{};
+                mt.preset = preset_;
+                mt.check = LZMA_CHECK_CRC64;
+                if (input_size.has_value()) {
+                    // smaller blocks than default (3 * dictionary size) to use all threads for charts and seqdb of tens of MiB
+                    mt.block_size = std::max(*input_size / threads + 1, xz_internal::MinBlockSize);
+                    mt.threads = std::min(threads, static_cast<uint32_t>(*input_size / mt.block_size + 1));
+                }
+                else {
+                    mt.block_size = xz_internal::StreamingBlockSize;
+                    mt.threads = threads;
+                }
+                while (mt.threads > 1 && lzma_stream_encoder_mt_memusage(&mt) > lzma_physmem() / 4)
+                    --mt.threads;
+                if (lzma_stream_encoder_mt(&strm_, &mt) != LZMA_OK)
+                    throw compressor_failed("lzma compression failed 1");
+                return;
+            }
+#endif
+            if (lzma_easy_encoder(&strm_, preset_, LZMA_CHECK_CRC64) != LZMA_OK)
+                throw compressor_failed("lzma compression failed 1");
+        }
+
+        // streaming compression, passes buffer_ to sink_ when it is full and at the end of stream
+        void code(std::string_view input, lzma_action action)
+        {
+            strm_.next_in = reinterpret_cast<const uint8_t*>(input.data());
+            strm_.avail_in = input.size();
+            for (;;) {
+                const auto r = lzma_code(&strm_, action);
+                if (r == LZMA_BUF_ERROR && action == LZMA_RUN) // no progress possible (e.g. empty chunk), wait for more input
+                    break;
+                if (r != LZMA_OK && r != LZMA_STREAM_END)
+                    throw compressor_failed("lzma compression failed 2, code: " + std::to_string(static_cast<int>(r)));
+                const bool output_full = strm_.avail_out == 0;
+                if (output_full || r == LZMA_STREAM_END) {
+                    sink_(std::string_view{buffer_.data(), buffer_.size() - strm_.avail_out});
+                    strm_.next_out = reinterpret_cast<uint8_t*>(buffer_.data());
+                    strm_.avail_out = buffer_.size();
+                }
+                if (r == LZMA_STREAM_END || (action == LZMA_RUN && strm_.avail_in == 0 && !output_full))
+                    break;
+            }
+        }
 
         std::string process(std::string_view input, size_t padding, size_t buf_size)
         {
@@ -97,6 +228,30 @@ namespace ae::file
             }
             return output;
         }
+
+        std::string decode(std::string_view input, size_t expected_size)
+        {
+            strm_.next_in = reinterpret_cast<const uint8_t*>(input.data());
+            strm_.avail_in = input.size();
+            std::string output;
+            output.resize(expected_size + std::max(padding(), size_t{1})); // extra byte to let decoder see stream end without running out of output
+            size_t produced = 0;
+            for (;;) {
+                strm_.next_out = reinterpret_cast<uint8_t*>(output.data() + produced);
+                strm_.avail_out = output.size() - produced;
+                const auto r = lzma_code(&strm_, LZMA_FINISH);
+                produced = output.size() - strm_.avail_out;
+                if (r == LZMA_STREAM_END)
+                    break;
+                else if (r != LZMA_OK)
+                    throw compressor_failed("lzma decompression failed 2");
+                else if (strm_.avail_out == 0) // size was not known or index is wrong
+                    output.resize(output.size() * 2);
+            }
+            output.resize(produced);
+            output.reserve(produced + padding());
+            return output;
+        }
     };
 
 } // namespace ae::file
@@ -2,6 +2,7 @@
 #include "py/dynamic.hh"
 #include "chart/v3/selected-antigens-sera.hh"
 #include "chart/v3/merge.hh"
+#include "py/chart-v3.hh"
 
 // ----------------------------------------------------------------------
 
@@ -27,8 +28,7 @@ namespace ae::py
 
     // ----------------------------------------------------------------------
 
-    static inline std::pair<std::shared_ptr<Chart>, ae::chart::v3::merge_data_t> merge(std::shared_ptr<Chart> chart1, std::shared_ptr<Chart> chart2, std::string_view match,
-                                                                                       std::string_view merge_type, bool cca)
+    static inline ae::chart::v3::merge_settings_t merge_settings(std::string_view match, std::string_view merge_type, bool cca)
     {
         using namespace ae::chart::v3;
         merge_settings_t settings{
@@ -48,8 +48,18 @@ namespace ae::py
             settings.projection_merge = projection_merge_t::type5;
         else
             AD_WARNING("unrecognized merge type1 \"{}\"", merge_type);
+        return settings;
+    }
+
+    static inline std::pair<std::shared_ptr<Chart>, ae::chart::v3::merge_data_t> merge(std::shared_ptr<Chart> chart1, std::shared_ptr<Chart> chart2, std::string_view match,
+                                                                                       std::string_view merge_type, bool cca)
+    {
+        return ae::chart::v3::merge(chart1, chart2, merge_settings(match, merge_type, cca));
+    }
 
-        return ae::chart::v3::merge(chart1, chart2, settings);
+    static inline std::pair<std::shared_ptr<Chart>, ae::chart::v3::merge_report_t> merge_many(const std::vector<std::shared_ptr<Chart>>& charts, std::string_view match, bool cca)
+    {
+        return ae::chart::v3::merge(charts, merge_settings(match, "simple", cca));
     }
 
     // ----------------------------------------------------------------------
@@ -278,6 +288,35 @@ void ae::py::chart_v3_antigens(pybind11::module_& chart_v3_submodule)
 
     // ----------------------------------------------------------------------
 
+    pybind11::class_<selection_bits_t>(chart_v3_submodule, "SelectionBits")
+        .def("__and__", [](const selection_bits_t& bits, const selection_bits_t& other) { return bits & other; }) //
+        .def("__or__", [](const selection_bits_t& bits, const selection_bits_t& other) { return bits | other; })  //
+        .def("__invert__", &selection_bits_t::operator~)                                                         //
+        .def("__len__", &selection_bits_t::count)                                                                //
+        .def("indexes", &selection_bits_t::to_indexes<std::vector<size_t>>, pybind11::doc("antigen/serum indexes of the selection")) //
+        ;
+
+    pybind11::class_<AttributeIndexRef<Antigens>>(chart_v3_submodule, "AntigenAttributes")
+        .def("all", [](const AttributeIndexRef<Antigens>& ref) { return ref.index().all(); })                                                                       //
+        .def("clade", [](const AttributeIndexRef<Antigens>& ref, std::string_view clade) { return ref.index().clade(clade); }, "clade"_a)                            //
+        .def("any_clade", [](const AttributeIndexRef<Antigens>& ref, const std::vector<std::string>& clades) { return ref.index().any_clade(clades); }, "clades"_a) //
+        .def("clades", [](const AttributeIndexRef<Antigens>& ref) { return ref.index().clades(); })                                                                 //
+        .def("passage", &AttributeIndexRef<Antigens>::passage, "passage_type"_a, pybind11::doc("passage_type: \"egg\", \"cell\", \"reassortant\""))                //
+        .def(
+            "date_range", [](const AttributeIndexRef<Antigens>& ref, std::string_view first, std::string_view after_last) { return ref.index().date_range(first, after_last); },
+            "first"_a = "", "after_last"_a = "", pybind11::doc("antigens with date in [first, after_last)")) //
+        ;
+
+    pybind11::class_<AttributeIndexRef<Sera>>(chart_v3_submodule, "SerumAttributes")
+        .def("all", [](const AttributeIndexRef<Sera>& ref) { return ref.index().all(); })                                                                       //
+        .def("clade", [](const AttributeIndexRef<Sera>& ref, std::string_view clade) { return ref.index().clade(clade); }, "clade"_a)                            //
+        .def("any_clade", [](const AttributeIndexRef<Sera>& ref, const std::vector<std::string>& clades) { return ref.index().any_clade(clades); }, "clades"_a) //
+        .def("clades", [](const AttributeIndexRef<Sera>& ref) { return ref.index().clades(); })                                                                 //
+        .def("passage", &AttributeIndexRef<Sera>::passage, "passage_type"_a, pybind11::doc("passage_type: \"egg\", \"cell\", \"reassortant\""))                //
+        ;
+
+    // ----------------------------------------------------------------------
+
     pybind11::class_<SemanticAttributes>(chart_v3_submodule, "SemanticAttributes")
         .def("__str__", [](const SemanticAttributes& attrs) { return fmt::format("{}", attrs); })                                                //
         .def("add_clade", &SemanticAttributes::add_clade, "clade"_a)                                                                             //
@@ -312,6 +351,8 @@ void ae::py::chart_v3_antigens(pybind11::module_& chart_v3_submodule)
         .def("report", &common_antigens_sera_t::report, "indent"_a = 0)                                                     //
         ;
     chart_v3_submodule.def("merge", &ae::py::merge, "chart1"_a, "chart2"_a, "match"_a = "auto", "merge_type"_a = "simple", "combine_cheating_assays"_a = false);
+    chart_v3_submodule.def("merge_many", &ae::py::merge_many, "charts"_a, "match"_a = "auto", "combine_cheating_assays"_a = false,
+                           pybind11::doc("merges charts in one pass, the same as merging them pairwise in order with merge_type=\"simple\""));
 
     // ----------------------------------------------------------------------
 
@@ -319,6 +360,22 @@ void ae::py::chart_v3_antigens(pybind11::module_& chart_v3_submodule)
         .def("common", &merge_data_t::common_report, "indent"_a = 0) //
         ;
 
+    pybind11::class_<merge_report_t>(chart_v3_submodule, "MergeReport")               //
+        .def("common", [](const merge_report_t& report) { return report.common; }) //
+        ;
+
+    pybind11::class_<cumulative_merge_t>(chart_v3_submodule, "CumulativeMerge") //
+        .def(pybind11::init([](std::shared_ptr<Chart> merged, std::string_view match, bool cca) {
+                 return new cumulative_merge_t{merged, ae::py::merge_settings(match, "simple", cca)};
+             }),
+             "merged"_a, "match"_a = "auto", "combine_cheating_assays"_a = false, pybind11::doc("merged chart is modified in place"))                        //
+        .def("append", &cumulative_merge_t::append, "chart"_a)                                                                                          //
+        .def(
+            "finish", [](cumulative_merge_t& cumulative, bool rebuild) { return cumulative.finish(rebuild ? cumulative_merge_t::merged_titers::rebuild : cumulative_merge_t::merged_titers::update); },
+            "rebuild"_a = false, pybind11::doc("recomputes merged titers for antigens of the appended charts (or all if rebuild=True)")) //
+        .def("merged", &cumulative_merge_t::merged)                                                                                                    //
+        ;
+
     // ----------------------------------------------------------------------
 }
 
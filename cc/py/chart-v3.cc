@@ -169,11 +169,17 @@ void ae::py::chart_v3(pybind11::module_& mdl)
 
     pybind11::class_<Chart, std::shared_ptr<Chart>>(chart_v3_submodule, "Chart")                                       //
         .def(pybind11::init<>(), pybind11::doc("creates an empty chart"))                                              //
-        .def(pybind11::init<const std::filesystem::path&>(), "filename"_a, pybind11::doc("imports chart from a file")) //
+        .def(pybind11::init([](const std::filesystem::path& filename, bool lazy) { return std::make_shared<Chart>(filename, lazy ? chart_import::lazy : chart_import::complete); }), "filename"_a,
+             "lazy"_a = false, pybind11::doc("imports chart from a file, lazy: titers, projections and plot styles are parsed on first access")) //
         .def(pybind11::init<const Chart&>(), "chart"_a, pybind11::doc("clone chart"))                                  //
-        .def("write", &Chart::write, "filename"_a, pybind11::doc("exports chart into a file"))                         //
         .def(
-            "export", [](const Chart& chart) -> pybind11::bytes { return chart.export_to_json(); }, pybind11::doc("exports chart into json uncompressed, bytes")) //
+            "write", [](const Chart& chart, const std::filesystem::path& filename, int digits) { chart.write(filename, layout_precision{digits}); }, "filename"_a,
+            "layout_precision"_a = 0, pybind11::doc("exports chart into a file, .acb: binary format, layout_precision: significant digits of layout coordinates, 0: exact")) //
+        .def(
+            "export", [](const Chart& chart, int digits) -> pybind11::bytes { return chart.export_to_json(layout_precision{digits}); }, "layout_precision"_a = 0,
+            pybind11::doc("exports chart into json uncompressed, bytes")) //
+        .def(
+            "export_binary", [](const Chart& chart) -> pybind11::bytes { return chart.export_to_binary(); }, pybind11::doc("exports chart into the binary format (.acb), bytes")) //
 
         .def("__str__", [](const Chart& chart) { return chart.name(); }) //
         .def(
@@ -352,6 +358,19 @@ void ae::py::chart_v3(pybind11::module_& mdl)
             },                                   //
             pybind11::doc(R"(Select no sera.)")) //
 
+        .def(
+            "antigen_attributes", [](std::shared_ptr<Chart> chart) { return AttributeIndexRef<Antigens>{chart}; },
+            pybind11::doc(R"(Returns index of antigen attributes for fast selections, e.g.
+            chart.select_antigens_by(chart.antigen_attributes().clade("3C.2A1B") & chart.antigen_attributes().date_range(first="2021-01")))")) //
+        .def(
+            "serum_attributes", [](std::shared_ptr<Chart> chart) { return AttributeIndexRef<Sera>{chart}; }, pybind11::doc(R"(Returns index of serum attributes for fast selections.)")) //
+        .def(
+            "select_antigens_by", [](std::shared_ptr<Chart> chart, const selection_bits_t& bits) { return new SelectedAntigens{chart, bits}; }, "selection"_a,
+            pybind11::doc(R"(Select antigens using SelectionBits returned by antigen_attributes().)")) //
+        .def(
+            "select_sera_by", [](std::shared_ptr<Chart> chart, const selection_bits_t& bits) { return new SelectedSera{chart, bits}; }, "selection"_a,
+            pybind11::doc(R"(Select sera using SelectionBits returned by serum_attributes().)")) //
+
         .def("duplicates_distinct", &Chart::duplicates_distinct, pybind11::doc("make duplicating antigens/sera distinct")) //
 
         // ----------------------------------------------------------------------
@@ -490,6 +509,9 @@ void ae::py::chart_v3(pybind11::module_& mdl)
             "titer_of_layer", [](const Titers& titers, size_t layer_no, size_t ag_no, size_t sr_no) { return titers.titer_of_layer(layer_index{layer_no}, antigen_index{ag_no}, serum_index{sr_no}); },
             "layer_no"_a, "antigen_no"_a, "serum_no"_a)                                                                            //
         .def("set_from_layers_report", [](const Titers& titers) { return new TiterMergeReport{titers.set_from_layers_report()}; }) //
+        .def("version", &Titers::version, pybind11::doc("incremented on each titer modification")) //
+        .def("build_column_index", &Titers::build_column_index, pybind11::doc("build transposed index to speed up per-serum access (column bases, titrations_for_serum), index is rebuilt on the next access after titers are modified")) //
+        .def("drop_column_index", &Titers::drop_column_index)                                                                                                                                            //
         .def(
             "titrations_for_antigen", [](const Titers& titers, size_t antigen_no) { return titers.titrations_for_antigen(antigen_index{antigen_no}); }, "antigen_no"_a) //
         .def(
@@ -505,7 +527,7 @@ void ae::py::chart_v3(pybind11::module_& mdl)
         ;
 
     pybind11::class_<Titer>(chart_v3_submodule, "Titer")                                                                      //
-        .def("__str__", pybind11::overload_cast<>(&Titer::get, pybind11::const_))                                             //
+        .def("__str__", &Titer::get)                                                                                          //
         .def("logged", &Titer::logged)                                                                                        //
         .def("logged_with_thresholded", &Titer::logged_with_thresholded)                                                      //
         .def("value", &Titer::value)                                                                                          //
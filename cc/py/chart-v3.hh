@@ -1,6 +1,7 @@
 #include "chart/v3/chart.hh"
 #include "chart/v3/avidity-test.hh"
 #include "chart/v3/selected-antigens-sera.hh"
+#include "chart/v3/attribute-index.hh"
 #include "chart/v3/serum-circles.hh"
 
 // ----------------------------------------------------------------------
@@ -53,6 +54,27 @@ namespace ae::py
         auto serum_circles(double fold) const { return ae::chart::v3::serum_circles(*chart, projection, ae::chart::v3::serum_circle_fold{fold}); }
         auto serum_circle_for_multiple_sera(const serum_indexes& sera, double fold, bool conservative) const { return ae::chart::v3::serum_circle_for_multiple_sera(*chart, projection, sera, ae::chart::v3::serum_circle_fold{fold}, conservative); }
     };
+
+    // attribute index is owned by the chart and may be dropped and rebuilt when antigens/sera are modified, keep the chart, not the index
+    template <typename AgSr> struct AttributeIndexRef
+    {
+        std::shared_ptr<Chart> chart;
+
+        const ae::chart::v3::attribute_index_t<AgSr>& index() const { return std::as_const(*chart).attributes<AgSr>(); }
+
+        // the same meaning as passage_is() for the predicate based selection
+        ae::chart::v3::selection_bits_t passage(std::string_view passage_type) const
+        {
+            if (passage_type == "reassortant")
+                return index().reassortant();
+            else if (passage_type == "egg")
+                return index().egg() & ~index().reassortant();
+            else if (passage_type == "cell")
+                return index().cell();
+            else
+                throw std::invalid_argument{fmt::format("unrecognized passage: \"{}\"", passage_type)};
+        }
+    };
 }
 
 // ----------------------------------------------------------------------
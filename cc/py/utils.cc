@@ -31,6 +31,9 @@ void ae::py::utils(pybind11::module_& mdl)
 
     mdl.def(
         "read_file", [](pybind11::object filename) { return ae::file::read(std::string{pybind11::str(filename)}); }, "filename"_a);
+    mdl.def(
+        "xz_settings", [](uint32_t preset, bool extreme, uint32_t threads) { ae::file::xz_settings(ae::file::xz_settings_t{.preset = preset, .extreme = extreme, .threads = threads}); }, "preset"_a = 9, "extreme"_a = true,
+        "threads"_a = 0, pybind11::doc("xz compression settings for writing .xz files (charts, seqdb), threads: 0 - number of cores"));
 }
 
 // ======================================================================
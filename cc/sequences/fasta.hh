@@ -15,7 +15,7 @@ namespace ae::sequences::fasta
     class Reader
     {
       public:
-        Reader(const std::filesystem::path& filename) : filename_{filename}, data_{ae::file::read(filename)} {}
+        Reader(const std::filesystem::path& filename) : filename_{filename}, data_{filename} {}
 
         struct value_t
         {
@@ -64,7 +64,7 @@ namespace ae::sequences::fasta
 
       private:
         std::filesystem::path filename_;
-        std::string data_;
+        ae::file::read_view_t data_; // memory mapped if not compressed
     };
 }
 
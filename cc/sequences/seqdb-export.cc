@@ -200,6 +200,16 @@ void ae::sequences::Seqdb::make_hash_index()
 // ----------------------------------------------------------------------
 
 std::string ae::sequences::Seqdb::export_to_string() const
+{
+    std::string result;
+    export_to([&result](std::string_view chunk) { result.append(chunk); });
+    return result;
+
+} // ae::sequences::Seqdb::export_to_string
+
+// ----------------------------------------------------------------------
+
+void ae::sequences::Seqdb::export_to(const ae::file::chunk_sink_t& sink) const
 {
     const auto make_str_for_json = [](auto&& src) -> std::string {
         for (char cc : src) {
@@ -216,6 +226,7 @@ std::string ae::sequences::Seqdb::export_to_string() const
     };
 
     fmt::memory_buffer json;
+    constexpr size_t chunk_size{1024 * 1024};
     fmt::format_to(
         std::back_inserter(json),
         "{{\"_\": \"-*- js-indent-level: 1 -*-\",\n \"  version\": \"sequence-database-v4\",\n \"  date\": \"{:%Y-%m-%d %H:%M %Z}\",\n \"size\": {:d},\n \"subtype\": \"{}\",\n \"data\": [\n",
@@ -321,13 +332,17 @@ std::string ae::sequences::Seqdb::export_to_string() const
             fmt::format_to(std::back_inserter(json), ",");
         fmt::format_to(std::back_inserter(json), "\n");
         ++entry_no;
+
+        if (json.size() >= chunk_size) {
+            sink(std::string_view{json.data(), json.size()});
+            json.clear();
+        }
     }
 
     fmt::format_to(std::back_inserter(json), " ]\n}}\n");
+    sink(std::string_view{json.data(), json.size()});
 
-    return fmt::to_string(json);
-
-} // ae::sequences::Seqdb::export_to_string
+} // ae::sequences::Seqdb::export_to
 
 // ----------------------------------------------------------------------
 
@@ -344,7 +359,9 @@ void ae::sequences::Seqdb::save() const
 void ae::sequences::Seqdb::save(const std::filesystem::path& filename) const
 {
     Timeit ti{fmt::format("exporting seqdb {} to {}", subtype_, filename)};
-    ae::file::write(filename, export_to_string(), ae::file::force_compression::no, ae::file::backup_file::yes);
+    ae::file::output_sink_t output{filename, ae::file::force_compression::no, ae::file::backup_file::yes};
+    export_to(output.sink());
+    output.finish();
 
 } // ae::sequences::Seqdb::save
 
@@ -6,6 +6,7 @@
 #include <memory>
 
 #include "ext/compare.hh"
+#include "ext/compressor.hh"
 #include "utils/log.hh"
 #include "utils/hash.hh"
 #include "utils/string-hash.hh"
@@ -131,6 +132,7 @@ namespace ae::sequences
 
         std::filesystem::path filename() const;
         std::string export_to_string() const;
+        void export_to(const ae::file::chunk_sink_t& sink) const; // in chunks, see file::output_sink_t
         void load();
         void make_hash_index();
         void remove(const SeqdbSeqRef& ref);
@@ -1,11 +1,85 @@
 #include <cstdlib>
+#include <cstring>
 #include <array>
+#include <random>
+#include <unistd.h>
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/catch_session.hpp>
 
 #include "utils/float.hh"
+#include "utils/file.hh"
 #include "chart/v3/chart.hh"
+#include "chart/v3/chart-binary.hh"
+#include "chart/v3/attribute-index.hh"
+#include "chart/v3/stress.hh"
+#include "chart/v3/randomizer.hh"
+#include "chart/v3/relax-cache.hh"
+#include "chart/v3/relax-checkpoint.hh"
+#include "chart/v3/merge.hh"
+#include "ext/omp.hh"
+
+// ----------------------------------------------------------------------
+
+// sparse random titers in layers, every cell of the merged table is
+// titrated in at most number_of_layers layers
+static ae::chart::v3::Chart layered_chart(size_t number_of_antigens, size_t number_of_sera, size_t number_of_layers, bool more_than = false)
+{
+    using namespace ae::chart::v3;
+    Chart chart;
+    for (size_t ag_no = 0; ag_no < number_of_antigens; ++ag_no)
+        chart.antigens().add().name(ae::virus::Name{fmt::format("A(H3N2)/TEST/{}/2020", ag_no + 1)});
+    for (size_t sr_no = 0; sr_no < number_of_sera; ++sr_no)
+        chart.sera().add().name(ae::virus::Name{fmt::format("A(H3N2)/SERUM/{}/2019", sr_no + 1)});
+
+    std::mt19937 generator{17};
+    std::uniform_int_distribution<size_t> titer_no{0, 11}, percent{0, 99};
+    const std::array titers{"<10", "10", "20", "40", "80", "160", "320", "640", "1280", "<40", "2560", ">1280"};
+    auto& layers = chart.titers();
+    layers.create_layers(ae::layer_index{number_of_layers}, ae::antigen_index{number_of_antigens});
+    layers.number_of_sera(ae::serum_index{number_of_sera});
+    for (const auto layer_no : ae::layer_index{number_of_layers}) {
+        for (const auto ag_no : ae::antigen_index{number_of_antigens}) {
+            for (const auto sr_no : ae::serum_index{number_of_sera}) {
+                if (percent(generator) < 30) {
+                    if (const auto* titer = titers[titer_no(generator)]; more_than || titer[0] != '>')
+                        layers.set_titer_of_layer(layer_no, ag_no, sr_no, Titer{titer});
+                }
+            }
+        }
+    }
+    return chart;
+}
+
+// single layered table, reference antigens are homologous to the sera,
+// titers of reference antigens are the same in all tables unless
+// same_reference_titers is false
+static std::shared_ptr<ae::chart::v3::Chart> hi_table(const std::vector<size_t>& reference, const std::vector<size_t>& test, uint32_t seed, bool same_reference_titers = true)
+{
+    using namespace ae::chart::v3;
+    auto chart = std::make_shared<Chart>();
+    chart->info().name(fmt::format("table-{}", seed));
+    for (const auto no : reference)
+        chart->antigens().add().name(ae::virus::Name{fmt::format("A(H3N2)/REFERENCE/{}/2019", no)});
+    for (const auto no : test)
+        chart->antigens().add().name(ae::virus::Name{fmt::format("A(H3N2)/TEST/{}/2020", no)});
+    for (const auto no : reference)
+        chart->sera().add().name(ae::virus::Name{fmt::format("A(H3N2)/REFERENCE/{}/2019", no)});
+
+    const std::array titers{"<10", "10", "20", "40", "80", "160", "320", "640", "1280", "2560"};
+    std::mt19937 generator{seed};
+    std::uniform_int_distribution<size_t> titer_no{0, titers.size() - 1};
+    auto& table = chart->titers() = Titers{chart->antigens().size(), chart->sera().size()};
+    for (const auto ag_no : chart->antigens().size()) {
+        for (const auto sr_no : chart->sera().size()) {
+            if (*ag_no < reference.size() && same_reference_titers)
+                table.set_titer(ag_no, sr_no, Titer{titers[(reference[*ag_no] * 7 + reference[*sr_no] * 3) % titers.size()]});
+            else
+                table.set_titer(ag_no, sr_no, Titer{titers[titer_no(generator)]});
+        }
+    }
+    return chart;
+}
 
 // ----------------------------------------------------------------------
 
@@ -30,6 +104,755 @@ TEST_CASE("best stress", "{stress]") {
     REQUIRE(std::abs(chart.projections().best().stress() - 66.12473) < 10e-4);
 }
 
+TEST_CASE("lazy import", "[import]") {
+    const char* ae_root = std::getenv("AE_ROOT");
+    REQUIRE(ae_root != nullptr);
+
+    const auto filename = std::filesystem::path{ae_root} / "test" / "chart1.ace";
+    const ae::chart::v3::Chart complete{filename};
+    const ae::chart::v3::Chart lazy{filename, ae::chart::v3::chart_import::lazy};
+    const ae::chart::v3::Chart lazy_copy{lazy};
+    REQUIRE(lazy.antigens().size() == ae::antigen_index{22});
+    REQUIRE(lazy.titers().number_of_non_dont_cares() == 220);
+    REQUIRE(lazy.export_to_json() == complete.export_to_json());
+    REQUIRE(lazy_copy.export_to_json() == complete.export_to_json());
+
+    // malformed titers section: error on every access, other sections are not affected
+    auto json = complete.export_to_json();
+    const auto dense = json.find("\"l\":", json.find("\"t\":"));
+    REQUIRE(dense != std::string::npos);
+    const auto second_row = json.find('[', json.find('[', json.find('[', dense) + 1) + 1);
+    REQUIRE(second_row != std::string::npos);
+    json.insert(second_row + 1, "\"10\", ");
+    const ae::chart::v3::Chart malformed{std::string_view{json}, ae::chart::v3::chart_import::lazy};
+    REQUIRE(malformed.antigens().size() == ae::antigen_index{22});
+    REQUIRE_THROWS_AS(malformed.titers(), ae::chart::v3::Error);
+    REQUIRE_THROWS_AS(malformed.titers(), ae::chart::v3::Error);
+    REQUIRE(malformed.projections().size() == complete.projections().size());
+}
+
+TEST_CASE("binary chart round trip", "[import]") {
+    const char* ae_root = std::getenv("AE_ROOT");
+    REQUIRE(ae_root != nullptr);
+
+    ae::chart::v3::Chart chart{std::filesystem::path{ae_root} / "test" / "chart1.ace"};
+    chart.relax(ae::chart::v3::number_of_optimizations_t{3}, ae::chart::v3::minimum_column_basis{"none"}, ae::number_of_dimensions_t{2}, ae::chart::v3::optimization_options{});
+    const auto binary = chart.export_to_binary();
+    REQUIRE(ae::chart::v3::binary::is_binary(binary));
+    const ae::chart::v3::Chart imported{std::string_view{binary}};
+    REQUIRE(imported.export_to_json() == chart.export_to_json());
+
+    const ae::chart::v3::binary::view_t view{std::string_view{binary}};
+    REQUIRE(view.number_of_projections() == chart.projections().size());
+    const auto layout = view.layout(ae::projection_index{1});
+    const auto expected = chart.projections()[ae::projection_index{1}].layout().span();
+    REQUIRE(std::equal(layout.begin(), layout.end(), expected.begin(), expected.end(), [](double e1, double e2) { return float_equal(e1, e2); }));
+}
+
+TEST_CASE("binary sparse chart with layers", "[import]") {
+    using namespace ae::chart::v3;
+
+    auto chart = layered_chart(40, 9, 3);
+    chart.titers().set_from_layers(chart);
+    sparse_titers_builder_t builder{chart.antigens().size()};
+    for (const auto titer_ref : chart.titers().titers_existing())
+        builder.add(titer_ref.antigen, titer_ref.serum, titer_ref.titer);
+    chart.titers().create_sparse_titers() = builder.build();
+    chart.titers().number_of_sera(chart.sera().size());
+    REQUIRE(!chart.titers().is_dense());
+
+    const auto binary = chart.export_to_binary();
+    const Chart imported{std::string_view{binary}};
+    REQUIRE(!imported.titers().is_dense());
+    REQUIRE(imported.titers() == chart.titers());
+    REQUIRE(imported.titers().number_of_layers() == ae::layer_index{3});
+    REQUIRE(imported.export_to_json() == chart.export_to_json());
+
+    // corrupted data is rejected
+    const binary::view_t view{std::string_view{binary}};
+    const auto& main_table = *std::find_if(view.sections().begin(), view.sections().end(), [](const auto& section) { return section.type == binary::section_type::titers && section.number == 0; });
+    const auto corrupt = [&binary](size_t offset, auto value) {
+        auto corrupted = binary;
+        std::memcpy(corrupted.data() + offset, &value, sizeof(value));
+        return corrupted;
+    };
+    const auto row_offsets_offset = main_table.offset + sizeof(binary::titers_header_t);
+    const auto sera_offset = row_offsets_offset + (*chart.antigens().size() + 1) * sizeof(uint64_t);
+    const auto section_offset = sizeof(binary::header_t) + static_cast<size_t>(&main_table - view.sections().data()) * sizeof(binary::section_t);
+    REQUIRE_THROWS_AS(Chart{std::string_view{corrupt(sera_offset, uint32_t{9})}}, Error);
+    REQUIRE_THROWS_AS(Chart{std::string_view{corrupt(row_offsets_offset + sizeof(uint64_t), ~uint64_t{0})}}, Error);
+    REQUIRE_THROWS_AS(Chart{std::string_view{corrupt(section_offset + offsetof(binary::section_t, size), ~uint64_t{0} - 7)}}, Error); // offset + size overflows
+
+    // layout not matching the chart is rejected
+    auto with_layout = chart;
+    with_layout.projections().add(with_layout.number_of_points(), ae::number_of_dimensions_t{2}, minimum_column_basis{"none"});
+    const auto binary_layout = with_layout.export_to_binary();
+    REQUIRE_NOTHROW(Chart{std::string_view{binary_layout}});
+    const binary::view_t layout_view{std::string_view{binary_layout}};
+    const auto& layout_section = *std::find_if(layout_view.sections().begin(), layout_view.sections().end(), [](const auto& section) { return section.type == binary::section_type::layout; });
+    const auto corrupt_layout = [&binary_layout, &layout_section](size_t field_offset, uint64_t value) {
+        auto corrupted = binary_layout;
+        std::memcpy(corrupted.data() + layout_section.offset + field_offset, &value, sizeof(value));
+        return corrupted;
+    };
+    REQUIRE_THROWS_AS(Chart{std::string_view{corrupt_layout(offsetof(binary::layout_header_t, number_of_points), *with_layout.number_of_points() - 1)}}, Error);
+    REQUIRE_THROWS_AS(Chart{std::string_view{corrupt_layout(offsetof(binary::layout_header_t, number_of_dimensions), 0)}}, Error);
+    REQUIRE_THROWS_AS(Chart{std::string_view{corrupt_layout(offsetof(binary::layout_header_t, number_of_dimensions), uint64_t{1} << 40)}}, Error);
+}
+
+TEST_CASE("relax cache", "[relax]") {
+    using namespace ae::chart::v3;
+    const char* ae_root = std::getenv("AE_ROOT");
+    REQUIRE(ae_root != nullptr);
+
+    const auto cache_dir = std::filesystem::temp_directory_path() / fmt::format("ae-relax-cache-test.{}", getpid());
+    relax_cache::settings(relax_cache::settings_t{.directory = cache_dir});
+    optimization_options options;
+    options.seed = 17;
+    const auto relax = [&options](Chart& chart) { chart.relax(number_of_optimizations_t{3}, minimum_column_basis{"none"}, ae::number_of_dimensions_t{2}, options); };
+
+    Chart chart1{std::filesystem::path{ae_root} / "test" / "chart1.ace"}, chart2{chart1}, chart3{chart1};
+    relax(chart1);
+    REQUIRE(std::distance(std::filesystem::directory_iterator{cache_dir}, std::filesystem::directory_iterator{}) == 1);
+    relax(chart2); // from cache
+    REQUIRE(chart2.export_to_binary() == chart1.export_to_binary());
+    options.cache = use_relax_cache::no;
+    relax(chart3); // seeded, the same result
+    REQUIRE(chart3.export_to_binary() == chart1.export_to_binary());
+
+    relax_cache::settings(relax_cache::settings_t{});
+    std::filesystem::remove_all(cache_dir);
+}
+
+TEST_CASE("relax checkpoint", "[relax]") {
+    using namespace ae::chart::v3;
+    const char* ae_root = std::getenv("AE_ROOT");
+    REQUIRE(ae_root != nullptr);
+
+    const auto dir = std::filesystem::temp_directory_path() / fmt::format("ae-relax-checkpoint-test.{}", getpid());
+    std::filesystem::create_directories(dir);
+    const auto checkpoint = dir / "relax.acb";
+    relax_checkpoint::parameters_t parameters{.number_of_optimizations = 6, .keep_projections = 3};
+    parameters.optimization.seed = 17;
+    parameters.optimization.cache = use_relax_cache::no;
+
+    const Chart source{std::filesystem::path{ae_root} / "test" / "chart1.ace"};
+    Chart uninterrupted{source}, interrupted{source}, resumed{source}, other{source};
+    REQUIRE(relax_checkpoint::relax(uninterrupted, parameters, std::nullopt, 0) == 0);
+
+    struct interruption {};
+    REQUIRE_THROWS_AS(relax_checkpoint::relax(interrupted, parameters, checkpoint, 2, [](size_t completed) { if (completed == 4) throw interruption{}; }), interruption);
+    REQUIRE(std::filesystem::exists(checkpoint));
+    REQUIRE(std::distance(std::filesystem::directory_iterator{dir}, std::filesystem::directory_iterator{}) == 1);
+    REQUIRE(binary::view_t{checkpoint}.number_of_projections() == ae::projection_index{3});
+
+    // other parameters or another table
+    auto other_parameters = parameters;
+    other_parameters.number_of_dimensions = ae::number_of_dimensions_t{3};
+    REQUIRE_THROWS_AS(relax_checkpoint::relax(other, other_parameters, checkpoint, 2), Error);
+    other_parameters = parameters;
+    other_parameters.optimization.seed = 18;
+    REQUIRE_THROWS_AS(relax_checkpoint::relax(other, other_parameters, checkpoint, 2), Error);
+    Chart other_titer{source};
+    const auto titer = other_titer.titers().titer(ae::antigen_index{0}, ae::serum_index{0});
+    other_titer.titers().set_titer(ae::antigen_index{0}, ae::serum_index{0}, titer == Titer{"40"} ? Titer{"80"} : Titer{"40"});
+    REQUIRE_THROWS_AS(relax_checkpoint::relax(other_titer, parameters, checkpoint, 2), Error);
+    Chart other_name{source};
+    other_name.antigens()[ae::antigen_index{1}].name(ae::virus::Name{"A(H3N2)/OTHER/1/2020"});
+    REQUIRE_THROWS_AS(relax_checkpoint::relax(other_name, parameters, checkpoint, 2), Error);
+
+    std::vector<size_t> progress;
+    REQUIRE(relax_checkpoint::relax(resumed, parameters, checkpoint, 2, [&progress](size_t completed) { progress.push_back(completed); }) == 4);
+    REQUIRE(progress == std::vector<size_t>{4});
+    REQUIRE(resumed.export_to_binary() == uninterrupted.export_to_binary());
+
+    // projections the chart had before compete with the new ones
+    Chart with_original{uninterrupted};
+    auto more = parameters;
+    more.optimization.seed = 19;
+    REQUIRE(relax_checkpoint::relax(with_original, more, std::nullopt, 0) == 0);
+    REQUIRE(with_original.projections().size() == ae::projection_index{3});
+    REQUIRE(with_original.projections().best().stress() <= uninterrupted.projections().best().stress());
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("layout export round trip", "[export]") {
+    using namespace ae::chart::v3;
+    const char* ae_root = std::getenv("AE_ROOT");
+    REQUIRE(ae_root != nullptr);
+
+    Chart chart{std::filesystem::path{ae_root} / "test" / "chart1.ace"};
+    auto& projection = chart.projections().add(chart.number_of_points(), ae::number_of_dimensions_t{2}, minimum_column_basis{});
+    auto coordinates = projection.layout().span();
+    const std::array special{0.1, 1.0 / 3.0, -2.5e-300, 1.5e300, 5e-324, -0.0, 123456789.123456789, 1e16, -7.0};
+    std::mt19937_64 generator{17};
+    std::uniform_real_distribution<double> distribution{-10.0, 10.0};
+    for (size_t no = 0; no < coordinates.size(); ++no)
+        coordinates[no] = no < special.size() ? special[no] : distribution(generator);
+
+    const Chart exact{std::string_view{chart.export_to_json()}};
+    const auto exact_coordinates = exact.projections()[ae::projection_index{0}].layout().span();
+    REQUIRE(std::equal(coordinates.begin(), coordinates.end(), exact_coordinates.begin(), exact_coordinates.end()));
+
+    const Chart rounded{std::string_view{chart.export_to_json(layout_precision{5})}};
+    const auto rounded_coordinates = rounded.projections()[ae::projection_index{0}].layout().span();
+    for (size_t no = 0; no < coordinates.size(); ++no)
+        REQUIRE(std::abs(rounded_coordinates[no] - coordinates[no]) <= std::abs(coordinates[no]) * 1e-4);
+}
+
+TEST_CASE("output sink", "[export]") {
+    const auto dir = std::filesystem::temp_directory_path() / fmt::format("ae-output-sink-test.{}", getpid());
+    std::filesystem::create_directories(dir);
+    std::string document;
+    for (size_t no = 0; document.size() < 300000; ++no)
+        document.append(fmt::format("{{\"no\": {}, \"value\": {}}},\n", no, no * 7919 % 1000));
+
+    for (const auto* extension : {".xz", ".gz", ".bz2", ".br", ""}) {
+        const auto filename = dir / fmt::format("document.json{}", extension);
+        {
+            ae::file::output_sink_t output{filename, ae::file::force_compression::no, ae::file::backup_file::no};
+            const auto sink = output.sink();
+            for (size_t offset = 0; offset < document.size(); offset += 65536)
+                sink(std::string_view{document}.substr(offset, 65536));
+            REQUIRE(!std::filesystem::exists(filename));
+            output.finish();
+        }
+        REQUIRE(ae::file::read(filename) == document);
+        if (*extension != 0)
+            REQUIRE(std::filesystem::file_size(filename) < document.size());
+
+        // interrupted export: previous file is kept, temporary file is removed
+        try {
+            ae::file::output_sink_t output{filename, ae::file::force_compression::no, ae::file::backup_file::no};
+            output.append("{\"incomplete\": ");
+            throw std::runtime_error{"export failed"};
+        }
+        catch (std::runtime_error&) {
+        }
+        REQUIRE(ae::file::read(filename) == document);
+        REQUIRE(std::distance(std::filesystem::directory_iterator{dir}, std::filesystem::directory_iterator{}) == 1);
+        std::filesystem::remove(filename);
+    }
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("parallel export", "[export]") {
+    using namespace ae::chart::v3;
+
+    auto chart = layered_chart(60, 10, 5);
+    chart.titers().set_from_layers(chart);
+    std::mt19937_64 generator{17};
+    std::uniform_real_distribution<double> distribution{-10.0, 10.0};
+    for (size_t projection_no = 0; projection_no < 6; ++projection_no) {
+        auto& projection = chart.projections().add(chart.number_of_points(), ae::number_of_dimensions_t{2 + projection_no % 2}, minimum_column_basis{});
+        for (auto& coordinate : projection.layout().span())
+            coordinate = distribution(generator);
+        projection.stress(static_cast<double>(projection_no) + 0.5);
+    }
+
+    const auto max_threads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    const auto serial = chart.export_to_json();
+    omp_set_num_threads(4);
+    const auto parallel = chart.export_to_json();
+    omp_set_num_threads(max_threads);
+    REQUIRE(parallel == serial);
+    REQUIRE(Chart{std::string_view{parallel}}.projections().size() == ae::projection_index{6});
+}
+
+TEST_CASE("titer encoding", "[titers]") {
+    using namespace ae::chart::v3;
+
+    static_assert(sizeof(Titer) == 4);
+    for (const auto* source : {"*", "10", "40", "<40", ">10240", "~80", "1437", "163840"})
+        REQUIRE(Titer{source}.get() == source);
+
+    REQUIRE(Titer{}.is_dont_care());
+    REQUIRE(Titer{"<40"}.is_less_than());
+    REQUIRE(Titer{"<40"}.value() == 40);
+    REQUIRE(Titer{"<40"}.value_with_thresholded() == 20);
+    REQUIRE(float_equal(Titer{"1280"}.logged(), 7.0));
+    REQUIRE(float_equal(Titer{"<40"}.logged_with_thresholded(), 1.0));
+    REQUIRE(Titer{"<40"}.multiplied_by(2.0) == Titer{"<80"});
+    REQUIRE(Titer::from_logged(2.0) == Titer{"40"});
+    REQUIRE(Titer{"20"} < Titer{"<40"});
+    REQUIRE_THROWS_AS(Titer{"4O"}, invalid_titer);
+    REQUIRE_THROWS_AS(Titer{"<"}, invalid_titer);
+    REQUIRE_THROWS_AS(Titer{"*40"}, invalid_titer);
+}
+
+TEST_CASE("sparse titers", "[titers]") {
+    using namespace ae::chart::v3;
+    using ae::antigen_index, ae::serum_index;
+
+    // unordered input, the last added titer of a cell is used, dont-cares are not stored
+    sparse_titers_builder_t builder;
+    for ([[maybe_unused]] const auto ag_no : antigen_index{4})
+        builder.add_antigen();
+    builder.add(antigen_index{2}, serum_index{1}, Titer{"40"});
+    builder.add(antigen_index{0}, serum_index{2}, Titer{"80"});
+    builder.add(antigen_index{0}, serum_index{0}, Titer{"<10"});
+    builder.add(antigen_index{2}, serum_index{1}, Titer{"160"});
+    builder.add(antigen_index{3}, serum_index{0}, Titer{});
+    auto sparse = builder.build();
+    REQUIRE(sparse.size() == 4);
+    REQUIRE(sparse.number_of_entries() == 3);
+    REQUIRE(sparse.row_offsets() == std::vector<size_t>{0, 2, 2, 3, 3});
+    REQUIRE(sparse.find(antigen_index{0}, serum_index{0}) == Titer{"<10"});
+    REQUIRE(sparse.find(antigen_index{2}, serum_index{1}) == Titer{"160"});
+    REQUIRE(sparse.find(antigen_index{1}, serum_index{1}).is_dont_care());
+
+    sparse.set(antigen_index{1}, serum_index{2}, Titer{"20"});   // insert
+    sparse.set(antigen_index{0}, serum_index{0}, Titer{"1280"}); // replace
+    sparse.set(antigen_index{0}, serum_index{2}, Titer{});       // remove
+    sparse.set(antigen_index{3}, serum_index{1}, Titer{});       // remove absent
+    REQUIRE(sparse.row_offsets() == std::vector<size_t>{0, 1, 2, 3, 3});
+    REQUIRE(sparse.sera() == std::vector<serum_index>{serum_index{0}, serum_index{2}, serum_index{1}});
+    REQUIRE(sparse.titers() == std::vector<Titer>{Titer{"1280"}, Titer{"20"}, Titer{"160"}});
+
+    ae::antigen_indexes antigens_to_remove;
+    antigens_to_remove.insert(antigen_index{0});
+    sparse.remove_antigens(antigens_to_remove);
+    REQUIRE(sparse.row_offsets() == std::vector<size_t>{0, 1, 2, 2});
+    ae::serum_indexes sera_to_remove;
+    sera_to_remove.insert(serum_index{1});
+    sparse.remove_sera(sera_to_remove);
+    REQUIRE(sparse.row_offsets() == std::vector<size_t>{0, 1, 1, 1});
+    REQUIRE(sparse.find(antigen_index{0}, serum_index{1}) == Titer{"20"});
+
+    // editing keeps sparse main table sparse
+    Titers titers;
+    titers.create_sparse_titers() = std::move(sparse);
+    titers.number_of_sera(serum_index{2});
+    titers.build_column_index();
+    REQUIRE(titers.number_of_non_dont_cares() == 1);
+    titers.set_titer(antigen_index{2}, serum_index{0}, Titer{">640"});
+    titers.set_titer(antigen_index{1}, serum_index{1}, Titer{"40"});
+    titers.set_titer(antigen_index{1}, serum_index{1}, Titer{"80"});
+    titers.set_titer(antigen_index{0}, serum_index{1}, Titer{});
+    REQUIRE(!titers.is_dense());
+    REQUIRE(titers.sparse_titers().row_offsets() == std::vector<size_t>{0, 0, 1, 2});
+    REQUIRE(titers.number_of_antigens() == antigen_index{3});
+    REQUIRE(titers.titer(antigen_index{0}, serum_index{1}).is_dont_care());
+    REQUIRE(titers.titer(antigen_index{1}, serum_index{1}) == Titer{"80"});
+    REQUIRE(titers.titer(antigen_index{2}, serum_index{0}) == Titer{">640"});
+    REQUIRE(titers.number_of_non_dont_cares() == 2);
+    REQUIRE(titers.column_index()[1].size() == 1);
+}
+
+TEST_CASE("merge titers from layers", "[titers]") {
+    using namespace ae::chart::v3;
+
+    const auto merge = [](const Chart& source, int number_of_threads) {
+        omp_set_num_threads(number_of_threads);
+        Chart chart{source};
+        const auto report = chart.titers().set_from_layers(chart);
+        return std::pair{chart, report};
+    };
+    const auto max_threads = omp_get_max_threads();
+    for (const bool more_than : {false, true}) {
+        const auto source = layered_chart(200, 12, 4, more_than);
+        const auto [serial, serial_report] = merge(source, 1);
+        const auto [parallel, parallel_report] = merge(source, 4);
+        omp_set_num_threads(max_threads);
+
+        REQUIRE(parallel.titers() == serial.titers());
+        REQUIRE(parallel.forced_column_bases().data() == serial.forced_column_bases().data());
+        REQUIRE(parallel_report.size() == serial_report.size());
+        REQUIRE(serial_report.size() == 200 * 12);
+        for (size_t no = 0; no < serial_report.size(); ++no) {
+            const auto& data = serial_report[no];
+            REQUIRE(data.antigen == ae::antigen_index{no / 12});
+            REQUIRE(data.serum == ae::serum_index{no % 12});
+            REQUIRE(parallel_report[no].titer == data.titer);
+            REQUIRE(parallel_report[no].antigen == data.antigen);
+            REQUIRE(parallel_report[no].serum == data.serum);
+            REQUIRE(parallel_report[no].report == data.report);
+            REQUIRE(serial.titers().titer(data.antigen, data.serum) == data.titer);
+
+            // per cell reference
+            const auto layer_titers = source.titers().titers_for_layers(data.antigen, data.serum);
+            if (layer_titers.empty())
+                REQUIRE(data.report == Titers::titer_merge::all_dontcare);
+            else if (layer_titers.size() == 1 && layer_titers[0].is_regular())
+                REQUIRE(data.titer == layer_titers[0]);
+        }
+    }
+
+    // hand computed merged titers and per cell report, one antigen per rule of merge_titers()
+    struct expected_t
+    {
+        std::vector<const char*> layer_titers;
+        const char* merged;
+        Titers::titer_merge report;
+    };
+    const std::vector<expected_t> expected{
+        {{}, "*", Titers::titer_merge::all_dontcare},
+        {{"<20", ">1280"}, "*", Titers::titer_merge::less_and_more_than},
+        {{"<40", "<20"}, "<20", Titers::titer_merge::less_than_only},
+        {{">1280"}, "*", Titers::titer_merge::more_than_only_to_dontcare},
+        {{"20", "1280"}, "*", Titers::titer_merge::sd_too_big},                                           // log: 1, 7, SD 3
+        {{"40", "80", "160"}, "80", Titers::titer_merge::regular_only},                                   // mean log 3
+        {{"<80", "<160", "20"}, "<80", Titers::titer_merge::max_less_than_bigger_than_max_regular},       // min of < above 20
+        {{"<20", "20"}, "<40", Titers::titer_merge::less_than_and_regular},                               // next of max regular
+        {{">160", ">320", "1280"}, ">320", Titers::titer_merge::min_more_than_less_than_min_regular},     // max of > below 1280
+        {{">80", "80"}, ">40", Titers::titer_merge::more_than_and_regular},                               // previous of min regular
+    };
+    Chart source;
+    for (size_t ag_no = 0; ag_no < expected.size(); ++ag_no)
+        source.antigens().add().name(ae::virus::Name{fmt::format("A(H3N2)/TEST/{}/2020", ag_no + 1)});
+    source.sera().add().name(ae::virus::Name{"A(H3N2)/SERUM/1/2019"});
+    source.titers().create_layers(ae::layer_index{3}, ae::antigen_index{expected.size()});
+    source.titers().number_of_sera(ae::serum_index{1});
+    for (size_t ag_no = 0; ag_no < expected.size(); ++ag_no) {
+        for (size_t layer_no = 0; layer_no < expected[ag_no].layer_titers.size(); ++layer_no)
+            source.titers().set_titer_of_layer(ae::layer_index{layer_no}, ae::antigen_index{ag_no}, ae::serum_index{0}, Titer{expected[ag_no].layer_titers[layer_no]});
+    }
+    for (const int number_of_threads : {1, 4}) {
+        const auto [merged, report] = merge(source, number_of_threads);
+        omp_set_num_threads(max_threads);
+        REQUIRE(report.size() == expected.size());
+        for (size_t ag_no = 0; ag_no < expected.size(); ++ag_no) {
+            const Titer titer{expected[ag_no].merged};
+            REQUIRE(report[ag_no].antigen == ae::antigen_index{ag_no});
+            REQUIRE(report[ag_no].serum == ae::serum_index{0});
+            REQUIRE(report[ag_no].titer == titer);
+            REQUIRE(report[ag_no].report == expected[ag_no].report);
+            REQUIRE(merged.titers().titer(ae::antigen_index{ag_no}, ae::serum_index{0}) == titer);
+        }
+    }
+}
+
+TEST_CASE("merge many charts", "[merge]") {
+    using namespace ae::chart::v3;
+
+    for (const auto combine : {combine_cheating_assays::no, combine_cheating_assays::yes}) {
+        const merge_settings_t settings{.combine_cheating_assays_ = combine};
+        const std::vector charts{
+            hi_table({1, 2, 3}, {1, 2, 3, 4}, 1),
+            hi_table({1, 2, 3}, {3, 4, 5}, 2), // cheating assay
+            hi_table({2, 3, 4}, {1, 6}, 3),
+            hi_table({1, 2}, {7}, 4, false),
+        };
+
+        auto pairwise = merge(charts[0], charts[1], settings).first;
+        Titers::titer_merge_report pairwise_report;
+        for (auto chart = std::next(charts.begin(), 2); chart != charts.end(); ++chart) {
+            auto [merged, merge_data] = merge(pairwise, *chart, settings);
+            pairwise = merged;
+            pairwise_report = merge_data.titer_report();
+        }
+        const auto [merged, report] = merge(charts, settings);
+
+        REQUIRE(merged->antigens().size() == ae::antigen_index{11});
+        REQUIRE(merged->antigens() == pairwise->antigens());
+        REQUIRE(merged->sera() == pairwise->sera());
+        REQUIRE(merged->titers().number_of_layers() == ae::layer_index{4});
+        REQUIRE(merged->titers() == pairwise->titers());
+        for (const auto layer_no : merged->titers().number_of_layers())
+            REQUIRE(merged->titers().layer(layer_no) == pairwise->titers().layer(layer_no));
+        REQUIRE(merged->titers().number_of_non_dont_cares() == pairwise->titers().number_of_non_dont_cares());
+        REQUIRE(report.titers.size() == pairwise_report.size());
+        for (size_t no = 0; no < report.titers.size(); ++no)
+            REQUIRE(report.titers[no].titer == pairwise_report[no].titer);
+
+        // cheating assay: reference titers of the second table are not in its layer
+        const auto references_in_layer = merged->titers().antigens_sera_of_layer(ae::layer_index{1}).first.size();
+        REQUIRE(references_in_layer == (combine == combine_cheating_assays::yes ? 3ul : 6ul));
+    }
+}
+
+TEST_CASE("cumulative merge", "[merge]") {
+    using namespace ae::chart::v3;
+
+    const merge_settings_t settings{};
+    const std::vector charts{
+        hi_table({1, 2, 3}, {1, 2, 3, 4}, 1),
+        hi_table({1, 2, 3}, {3, 4, 5}, 2),
+        hi_table({2, 3, 4}, {1, 6}, 3),
+        hi_table({1, 2}, {7, 4}, 4, false),
+        hi_table({4}, {8}, 5),
+    };
+
+    auto pairwise = merge(charts[0], charts[1], settings).first;
+    for (auto chart = std::next(charts.begin(), 2); chart != charts.end(); ++chart)
+        pairwise = merge(pairwise, *chart, settings).first;
+
+    const auto cumulative = [&charts, &settings](cumulative_merge_t::merged_titers recompute) {
+        cumulative_merge_t merger{std::make_shared<Chart>(*merge(charts[0], charts[1], settings).first), settings};
+        merger.append(*charts[2]);
+        merger.finish(recompute);
+        merger.append(*charts[3]);
+        merger.append(*charts[4]);
+        merger.finish(recompute);
+        return merger.merged();
+    };
+    const auto updated = cumulative(cumulative_merge_t::merged_titers::update);
+    const auto rebuilt = cumulative(cumulative_merge_t::merged_titers::rebuild);
+
+    for (const auto& merged : {updated, rebuilt}) {
+        REQUIRE(merged->antigens() == pairwise->antigens());
+        REQUIRE(merged->sera() == pairwise->sera());
+        REQUIRE(merged->titers().number_of_layers() == ae::layer_index{5});
+        for (const auto layer_no : merged->titers().number_of_layers())
+            REQUIRE(merged->titers().layer(layer_no) == pairwise->titers().layer(layer_no));
+        for (const auto ag_no : pairwise->antigens().size()) {
+            for (const auto sr_no : pairwise->sera().size())
+                REQUIRE(merged->titers().titer(ag_no, sr_no) == pairwise->titers().titer(ag_no, sr_no));
+        }
+        REQUIRE(merged->titers().number_of_non_dont_cares() == pairwise->titers().number_of_non_dont_cares());
+    }
+
+    // sparse merged table is updated as sparse
+    Chart sparse = layered_chart(100, 20, 1);
+    auto& titers = sparse.titers();
+    titers.layers().emplace_back(ae::antigen_index{100});
+    for (const auto ag_no : ae::antigen_index{10})
+        titers.set_titer_of_layer(ae::layer_index{1}, ag_no, ae::serum_index{*ag_no}, Titer{"80"});
+    titers.set_from_layers(sparse);
+    REQUIRE(!titers.is_dense());
+    titers.layers().emplace_back(ae::antigen_index{100});
+    for (size_t ag_no = 5; ag_no < 15; ++ag_no)
+        titers.set_titer_of_layer(ae::layer_index{2}, ae::antigen_index{ag_no}, ae::serum_index{ag_no}, Titer{"160"});
+    const auto report = titers.update_from_layers(sparse, ae::layer_index{2});
+    REQUIRE(report.size() == 10 * 20);
+    REQUIRE(!titers.is_dense());
+    Chart sparse_rebuilt{sparse};
+    sparse_rebuilt.titers().set_from_layers(sparse_rebuilt);
+    REQUIRE(titers == sparse_rebuilt.titers());
+}
+
+TEST_CASE("titer column index", "[titers]") {
+    using namespace ae::chart::v3;
+
+    Titers titers{ae::antigen_index{3}, ae::serum_index{2}};
+    titers.set_titer(ae::antigen_index{0}, ae::serum_index{1}, Titer{"40"});
+    titers.set_titer(ae::antigen_index{2}, ae::serum_index{1}, Titer{"<20"});
+    const auto expected_column_bases = titers.raw_column_bases();
+
+    titers.build_column_index();
+    REQUIRE(titers.titrations_for_serum(ae::serum_index{0}) == 0);
+    REQUIRE(titers.titrations_for_serum(ae::serum_index{1}) == 2);
+    titers.set_titer(ae::antigen_index{1}, ae::serum_index{0}, Titer{"160"});
+    titers.set_titer(ae::antigen_index{2}, ae::serum_index{1}, Titer{});
+    REQUIRE(titers.titrations_for_serum(ae::serum_index{0}) == 1);
+    REQUIRE(titers.column_index()[1].antigens().size() == 1);
+    REQUIRE(float_equal(titers.raw_column_bases()[ae::serum_index{1}], expected_column_bases[ae::serum_index{1}]));
+    REQUIRE(float_equal(titers.raw_column_basis(ae::serum_index{0}), 4.0));
+
+    ae::antigen_indexes to_remove;
+    to_remove.push_back(ae::antigen_index{0});
+    titers.remove_antigens(to_remove);
+    REQUIRE(titers.titrations_for_serum(ae::serum_index{1}) == 0);
+    REQUIRE(titers.column_index()[0].antigens()[0] == ae::antigen_index{0});
+
+    // bulk edit: index is rebuilt once on the next access
+    Titers bulk{ae::antigen_index{50}, ae::serum_index{4}};
+    bulk.build_column_index();
+    for (size_t ag_no = 0; ag_no < 50; ++ag_no)
+        bulk.set_titer(ae::antigen_index{ag_no}, ae::serum_index{ag_no % 4}, Titer{"80"});
+    bulk.set_titer(ae::antigen_index{4}, ae::serum_index{0}, Titer{});
+    REQUIRE(bulk.has_column_index());
+    REQUIRE(bulk.column_index()[0].size() == 12);
+    REQUIRE(bulk.column_index()[0].antigens()[1] == ae::antigen_index{8});
+    REQUIRE(bulk.column_index()[3].size() == 12);
+    auto copy = bulk;
+    copy.set_titer(ae::antigen_index{4}, ae::serum_index{0}, Titer{"40"});
+    REQUIRE(copy.has_column_index());
+    REQUIRE(copy.column_index()[0].size() == 13);
+    REQUIRE(bulk.column_index()[0].size() == 12);
+    bulk.drop_column_index();
+    REQUIRE(!bulk.has_column_index());
+    REQUIRE(bulk.titrations_for_serum(ae::serum_index{0}) == 12);
+}
+
+TEST_CASE("titer statistics", "[titers]") {
+    using namespace ae::chart::v3;
+
+    Titers titers{ae::antigen_index{3}, ae::serum_index{2}};
+    titers.set_titer(ae::antigen_index{0}, ae::serum_index{0}, Titer{"80"});
+    titers.set_titer(ae::antigen_index{1}, ae::serum_index{0}, Titer{"20"});
+    titers.set_titer(ae::antigen_index{2}, ae::serum_index{1}, Titer{"<40"});
+    REQUIRE(float_equal(titers.raw_column_basis(ae::serum_index{0}), 3.0));
+    REQUIRE(titers.having_too_few_numeric_titers(1) == ae::point_indexes{std::vector{ae::point_index{2}, ae::point_index{4}}});
+
+    const auto version = titers.version();
+    titers.set_titer(ae::antigen_index{0}, ae::serum_index{0}, Titer{"10"});
+    REQUIRE(titers.version() > version);
+    titers.create_layers(ae::layer_index{2}, ae::antigen_index{3});
+    const auto layers_version = titers.version();
+    titers.set_titer_of_layer(ae::layer_index{1}, ae::antigen_index{2}, ae::serum_index{0}, Titer{"40"});
+    REQUIRE(titers.version() > layers_version);
+    REQUIRE(float_equal(titers.raw_column_basis(ae::serum_index{0}), 1.0));
+    titers.set_titer(ae::antigen_index{2}, ae::serum_index{1}, Titer{"640"});
+    REQUIRE(float_equal(titers.raw_column_basis(ae::serum_index{1}), 6.0));
+    REQUIRE(titers.titrations_for_serum(ae::serum_index{0}) == 2);
+    REQUIRE(titers.having_too_few_numeric_titers(1).empty());
+
+    ae::antigen_indexes to_remove;
+    to_remove.push_back(ae::antigen_index{2});
+    titers.remove_antigens(to_remove);
+    REQUIRE(float_equal(titers.raw_column_basis(ae::serum_index{1}), 0.0));
+    REQUIRE(titers.having_too_few_numeric_titers(1) == ae::point_indexes{std::vector{ae::point_index{3}}});
+
+    // concurrent readers of a copy: statistics is computed by one of them and returned by value
+    const auto copy = titers;
+    std::vector<double> bases(64, -1.0);
+    std::vector<size_t> too_few(64, 0);
+#pragma omp parallel for
+    for (size_t no = 0; no < bases.size(); ++no) {
+        bases[no] = copy.raw_column_bases()[ae::serum_index{no % 2}];
+        too_few[no] = copy.having_too_few_numeric_titers(1).size();
+    }
+    for (size_t no = 0; no < bases.size(); ++no) {
+        REQUIRE(float_equal(bases[no], titers.raw_column_basis(ae::serum_index{no % 2})));
+        REQUIRE(too_few[no] == 1);
+    }
+}
+
+TEST_CASE("attribute index", "[selection]") {
+    using namespace ae::chart::v3;
+
+    Antigens antigens;
+    for (const auto* date : {"2021-03-15", "", "2020-11", "2021-07-01"})
+        antigens.add().date(Date{date});
+    antigens[ae::antigen_index{0}].semantic().add_clade("2A1B");
+    antigens[ae::antigen_index{3}].semantic().add_clade("2A1B");
+    antigens[ae::antigen_index{3}].semantic().add_clade("2A2");
+
+    const attribute_index_t<Antigens> index{antigens};
+    REQUIRE(index.clade("2A1B").to_indexes<std::vector<size_t>>() == std::vector<size_t>{0, 3});
+    REQUIRE(index.clade("unknown").count() == 0);
+    REQUIRE(index.date_range("2021", "").to_indexes<std::vector<size_t>>() == std::vector<size_t>{0, 3});
+    REQUIRE(index.date_range("", "2021-04").to_indexes<std::vector<size_t>>() == std::vector<size_t>{0, 2});
+    REQUIRE((index.clade("2A1B") & ~index.clade("2A2")).to_indexes<std::vector<size_t>>() == std::vector<size_t>{0});
+    REQUIRE((~index.all()).count() == 0);
+    REQUIRE(attribute_index_t<Antigens>::date_to_int("2020-05-17") == 20200517u);
+    REQUIRE(!attribute_index_t<Antigens>::date_to_int("2020/05/17").has_value());
+
+    // chart index is rebuilt after modification via a retained reference
+    Chart chart;
+    chart.antigens() = antigens;
+    auto& antigen = chart.antigens()[ae::antigen_index{1}];
+    const Chart& const_chart = chart;
+    REQUIRE(const_chart.attributes<Antigens>().clade("2A1B").count() == 2);
+    antigen.semantic().add_clade("2A1B");
+    REQUIRE(const_chart.attributes<Antigens>().clade("2A1B").to_indexes<std::vector<size_t>>() == std::vector<size_t>{0, 1, 3});
+    antigen.date(Date{"2022-01-01"});
+    REQUIRE(const_chart.attributes<Antigens>().date_range("2022", "").to_indexes<std::vector<size_t>>() == std::vector<size_t>{1});
+
+    Chart copy{chart};
+    copy.antigens()[ae::antigen_index{0}].reassortant(ae::virus::Reassortant{"NYMC-263"});
+    REQUIRE(copy.attributes<Antigens>().reassortant().to_indexes<std::vector<size_t>>() == std::vector<size_t>{0});
+    REQUIRE(const_chart.attributes<Antigens>().reassortant().count() == 0);
+    copy.antigens().add().semantic().add_clade("2A2");
+    REQUIRE(copy.attributes<Antigens>().clade("2A2").to_indexes<std::vector<size_t>>() == std::vector<size_t>{3, 4});
+    REQUIRE(const_chart.attributes<Antigens>().size() == 4);
+
+    // edits of a copy (or of an assigned chart) are never mistaken for the state the copied index was built for
+    const auto edit_and_check = [&const_chart](Chart& edited) {
+        for (size_t edit = 0; edit <= const_chart.antigens().modifications() + 1; ++edit)
+            edited.antigens()[ae::antigen_index{2}].semantic().add_clade(fmt::format("ABA{}", edit));
+        REQUIRE(edited.attributes<Antigens>().clade("ABA0").to_indexes<std::vector<size_t>>() == std::vector<size_t>{2});
+    };
+    REQUIRE(const_chart.attributes<Antigens>().clade("ABA0").count() == 0);
+    Chart copied{chart};
+    edit_and_check(copied);
+    Chart assigned;
+    REQUIRE(assigned.attributes<Antigens>().size() == 0);
+    assigned = chart;
+    edit_and_check(assigned);
+    REQUIRE(const_chart.attributes<Antigens>().clade("ABA0").count() == 0);
+}
+
+TEST_CASE("designation cache", "[antigens]") {
+    using namespace ae::chart::v3;
+
+    Antigens antigens;
+    for (const auto* passage : {"E1", "MDCK1", "E1"}) {
+        auto& antigen = antigens.add();
+        antigen.name(ae::virus::Name{"A(H3N2)/TEST/1/2020"});
+        antigen.passage(ae::virus::Passage{passage});
+    }
+    REQUIRE(antigens[ae::antigen_index{0}].designation() == "A(H3N2)/TEST/1/2020 E1");
+    REQUIRE(antigens[ae::antigen_index{0}].designation_hash() == antigens[ae::antigen_index{2}].designation_hash());
+    REQUIRE(antigens[ae::antigen_index{0}].basic_designation_hash() == antigens[ae::antigen_index{1}].basic_designation_hash());
+    REQUIRE(antigens.find_duplicates().size() == 1);
+
+    antigens[ae::antigen_index{2}].passage(ae::virus::Passage{"E2"});
+    REQUIRE(antigens[ae::antigen_index{2}].designation() == "A(H3N2)/TEST/1/2020 E2");
+    REQUIRE(antigens[ae::antigen_index{2}].designation_hash() == ae::xxhash::xxhash64(antigens[ae::antigen_index{2}].designation()));
+    REQUIRE(antigens.find_duplicates().empty());
+    antigens[ae::antigen_index{1}].passage(ae::virus::Passage{"E2"});
+    antigens[ae::antigen_index{1}].annotations().set_distinct();
+    REQUIRE(antigens[ae::antigen_index{1}].designation() == "A(H3N2)/TEST/1/2020 DISTINCT E2");
+    REQUIRE(antigens.find_duplicates().empty());
+
+    // the string is cached next to its hash and reset together with it
+    const auto& antigen = antigens[ae::antigen_index{0}];
+    REQUIRE(&antigen.designation() == &antigen.designation());
+    REQUIRE(antigen.basic_designation() == "A(H3N2)/TEST/1/2020");
+    antigens[ae::antigen_index{0}].reassortant(ae::virus::Reassortant{"NYMC-1"});
+    REQUIRE(antigen.designation() == "A(H3N2)/TEST/1/2020 NYMC-1 E1");
+    REQUIRE(antigen.designation_hash() == ae::xxhash::xxhash64(antigen.designation()));
+    REQUIRE(antigen.basic_designation() == "A(H3N2)/TEST/1/2020 NYMC-1");
+    REQUIRE(antigen.basic_designation_hash() == ae::xxhash::xxhash64(antigen.basic_designation()));
+
+    Sera sera;
+    auto& serum = sera.add();
+    serum.name(ae::virus::Name{"A(H3N2)/TEST/1/2020"});
+    serum.serum_id(SerumId{"F1"});
+    REQUIRE(serum.designation() == "A(H3N2)/TEST/1/2020 F1");
+    serum.serum_id(SerumId{"F2"});
+    REQUIRE(serum.designation() == "A(H3N2)/TEST/1/2020 F2");
+    REQUIRE(serum.designation_hash() == ae::xxhash::xxhash64(std::string_view{"A(H3N2)/TEST/1/2020 F2"}));
+}
+
+TEST_CASE("active set stress", "[stress]") {
+    using namespace ae::chart::v3;
+
+    Stress stress{ae::number_of_dimensions_t{2}, ae::point_index{4}};
+    stress.table_distances().regular().emplace_back(ae::point_index{0}, ae::point_index{1}, 1.0);
+    stress.table_distances().regular().emplace_back(ae::point_index{0}, ae::point_index{2}, 2.0);
+    stress.table_distances().regular().emplace_back(ae::point_index{1}, ae::point_index{3}, 1.5);
+    stress.table_distances().less_than().emplace_back(ae::point_index{1}, ae::point_index{0}, 3.0);
+    stress.table_distances().less_than().emplace_back(ae::point_index{2}, ae::point_index{3}, 0.5);
+    ae::unmovable_points unmovable;
+    unmovable.insert(ae::point_index{0});
+    unmovable.insert(ae::point_index{1});
+    stress.set_unmovable(unmovable);
+
+    const auto active = stress.active_set();
+    REQUIRE(active.table_distances().regular().size() == 2);
+    REQUIRE(active.table_distances().less_than().size() == 1);
+
+    const std::array layout1{0.0, 0.0, 1.0, 0.5, 2.0, 1.0, -1.0, 2.0};
+    const std::array layout2{0.0, 0.0, 1.0, 0.5, 0.5, -1.0, 3.0, 0.0};
+    REQUIRE(std::abs((stress.value(layout1) - active.value(layout1)) - (stress.value(layout2) - active.value(layout2))) < 1e-10);
+    const auto gradient = stress.gradient(layout1), active_gradient = active.gradient(layout1);
+    for (size_t no = 0; no < gradient.size(); ++no)
+        REQUIRE(float_equal(gradient[no], active_gradient[no]));
+}
+
+TEST_CASE("randomizer streams", "[relax]") {
+    using namespace ae::chart::v3;
+
+    const LayoutRandomizerPlain randomizer{10.0, 17u};
+    const auto values = [](LayoutRandomizer& rnd) {
+        const auto coordinates = rnd.get(ae::number_of_dimensions_t{3});
+        return std::vector<double>(coordinates.begin(), coordinates.end());
+    };
+    const auto coordinates = [&randomizer, &values](size_t ordinal) { return values(*randomizer.stream(ordinal)); };
+    const auto first = coordinates(5), second = coordinates(6);
+    REQUIRE(coordinates(6) == second); // order of requests does not matter
+    REQUIRE(coordinates(5) == first);
+    REQUIRE(first != second);
+    REQUIRE(values(*LayoutRandomizerPlain{10.0, 17u}.stream(5)) == first);
+    REQUIRE(values(*LayoutRandomizerPlain{10.0, 18u}.stream(5)) != first);
+    REQUIRE(std::all_of(first.begin(), first.end(), [](double val) { return val >= -5.0 && val < 5.0; }));
+}
+
 int main(int argc, const char* const* argv)
 {
     return Catch::Session().run( argc, argv );
@@ -500,12 +500,12 @@ namespace ae::tree
 
 // ----------------------------------------------------------------------
 
-std::shared_ptr<ae::tree::Tree> ae::tree::load_json(const std::string& data, const std::filesystem::path& filename)
+std::shared_ptr<ae::tree::Tree> ae::tree::load_json(std::string_view data, const std::filesystem::path& filename)
 {
     auto tree = std::make_shared<Tree>();
     try {
         simdjson::ondemand::parser parser;
-        auto doc = parser.iterate(data, data.size() + simdjson::SIMDJSON_PADDING);
+        auto doc = parser.iterate(data.data(), data.size(), data.size() + simdjson::SIMDJSON_PADDING);
         const auto current_location_offset = [&doc, data] { return doc.current_location().value() - data.data(); };
         const auto current_location_snippet = [&doc](size_t size) { return std::string_view(doc.current_location().value(), size); };
 
@@ -544,7 +544,7 @@ std::shared_ptr<ae::tree::Tree> ae::tree::load_json(const std::string& data, con
 
 // ----------------------------------------------------------------------
 
-void ae::tree::load_join_json(const std::string& data, Tree& tree, Inode& join_at, const std::filesystem::path& filename)
+void ae::tree::load_join_json(std::string_view data, Tree& tree, Inode& join_at, const std::filesystem::path& filename)
 {
     fmt::print(stderr, "> load_join_json not implemented\n");
     throw std::runtime_error{AD_FORMAT("load_join_json not implemented")};
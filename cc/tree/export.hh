@@ -15,8 +15,9 @@ namespace ae::tree
     std::string export_json(const Tree& tree, const Inode& root);
 
     bool is_json(std::string_view data);
-    std::shared_ptr<Tree> load_json(const std::string& data, const std::filesystem::path& filename);
-    void load_join_json(const std::string& data, Tree& tree, Inode& join_at, const std::filesystem::path& filename);
+    // data must be followed by simdjson::SIMDJSON_PADDING readable bytes (file::read_view_t)
+    std::shared_ptr<Tree> load_json(std::string_view data, const std::filesystem::path& filename);
+    void load_join_json(std::string_view data, Tree& tree, Inode& join_at, const std::filesystem::path& filename);
 
 } // namespace ae::tree
 
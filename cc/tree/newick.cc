@@ -214,7 +214,7 @@ namespace ae::tree::newick
 
 // ----------------------------------------------------------------------
 
-std::shared_ptr<ae::tree::Tree> ae::tree::load_newick(const std::string& source)
+std::shared_ptr<ae::tree::Tree> ae::tree::load_newick(std::string_view source)
 {
     const bool trace { false };
 
@@ -242,7 +242,7 @@ std::shared_ptr<ae::tree::Tree> ae::tree::load_newick(const std::string& source)
 
 // ----------------------------------------------------------------------
 
-void ae::tree::load_join_newick(const std::string& source, Tree& tree, node_index_t join_at)
+void ae::tree::load_join_newick(std::string_view source, Tree& tree, node_index_t join_at)
 {
     try {
         newick::tree_builder_t tree_builder{tree, join_at};
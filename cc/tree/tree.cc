@@ -550,7 +550,7 @@ ae::tree::Nodes& ae::tree::Nodes::filter_seq_id(const std::vector<std::string>&
 std::shared_ptr<ae::tree::Tree> ae::tree::load(const std::filesystem::path& filename)
 {
     std::shared_ptr<ae::tree::Tree> tree;
-    const auto data = file::read(filename, ::simdjson::SIMDJSON_PADDING);
+    const file::read_view_t data{filename, ::simdjson::SIMDJSON_PADDING};
     if (is_newick(data))
         tree = load_newick(data);
     else if (is_json(data))
@@ -567,7 +567,7 @@ std::shared_ptr<ae::tree::Tree> ae::tree::load(const std::filesystem::path& file
 
 void ae::tree::load_subtree(const std::filesystem::path& filename, Tree& tree, node_index_t join_at)
 {
-    const auto data = file::read(filename, ::simdjson::SIMDJSON_PADDING);
+    const file::read_view_t data{filename, ::simdjson::SIMDJSON_PADDING};
     if (is_newick(data))
         load_join_newick(data, tree, join_at);
     else if (is_json(data))
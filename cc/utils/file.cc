@@ -6,6 +6,7 @@
 #include <sys/mman.h>
 
 #include <filesystem>
+#include <atomic>
 
 #include "utils/file.hh"
 #include "ext/brotli.hh"
@@ -18,12 +19,14 @@
 
 namespace ae::file::detail
 {
+    static xz_settings_t xz_settings_{};
+
     inline std::unique_ptr<Compressor> compressor_factory(std::string_view initial_bytes, const std::filesystem::path& filename, force_compression fc, size_t padding)
     {
         if ((!initial_bytes.empty() && brotli_compressed(initial_bytes)) || extension_of(filename, {".br", ".tjb", ".jbr"}))
             return std::make_unique<Brotli_Compressor>(padding);
         else if ((!initial_bytes.empty() && xz_compressed(initial_bytes)) || extension_of(filename, {".xz", ".tjz", ".jxz"}))
-            return std::make_unique<XZ_Compressor>(padding);
+            return std::make_unique<XZ_Compressor>(padding, xz_settings_.preset | (xz_settings_.extreme ? LZMA_PRESET_EXTREME : 0U), xz_settings_.threads);
         else if ((!initial_bytes.empty() && bz2_compressed(initial_bytes)) || extension_of(filename, {".bz2"}))
             return std::make_unique<BZ2_Compressor>(padding);
         else if ((!initial_bytes.empty() && gzip_compressed(initial_bytes)) || extension_of(filename, {".gz"}))
@@ -35,6 +38,43 @@ namespace ae::file::detail
 
     } // ae::file::read_access::compressor_factory
 
+    // stdout for "-", stderr for "=", /dev/null for "/"
+    inline int open_for_writing(const std::filesystem::path& filename, backup_file a_backup_file)
+    {
+        int f = -1;
+        if (filename == "-") {
+            f = 1;
+        }
+        else if (filename == "=") {
+            f = 2;
+        }
+        else if (filename == "/") {
+            f = open("/dev/null", O_WRONLY | O_TRUNC | O_CREAT, 0644);
+            if (f < 0)
+                throw std::runtime_error(fmt::format("Cannot open /dev/null: {}", strerror(errno)));
+        }
+        else {
+            if (a_backup_file == backup_file::yes && filename.native().substr(0, 4) != "/dev") // allow writing to /dev/ without making backup attempt
+                backup(filename);
+            f = open(filename.c_str(), O_WRONLY | O_TRUNC | O_CREAT, 0644);
+            if (f < 0)
+                throw std::runtime_error(fmt::format("Cannot open {}: {}", filename, strerror(errno)));
+        }
+        return f;
+    }
+
+    inline bool compressed_extension(const std::filesystem::path& filename) { return extension_of(filename, {".br", ".tjb", ".jbr", ".xz", ".gz", ".tjz", ".jxz", ".bz2"}); }
+
+    // stdout ("-"), stderr ("="), /dev/null ("/") and devices are written directly, not via a temporary file
+    inline bool written_directly(const std::filesystem::path& filename) { return filename == "-" || filename == "=" || filename == "/" || filename.native().substr(0, 4) == "/dev"; }
+
+    // in the same directory as filename for rename() to be atomic
+    inline std::filesystem::path temp_name(const std::filesystem::path& filename)
+    {
+        static std::atomic<size_t> counter{0};
+        return filename.parent_path() / fmt::format(".{}.{}-{}.tmp", filename.filename().native(), getpid(), counter++);
+    }
+
     inline std::string read_stdin(size_t padding)
     {
         constexpr size_t chunk_size = 1024 * 100;
@@ -54,45 +94,6 @@ namespace ae::file::detail
         return decompress_if_necessary(data, padding);
     }
 
-    class mmapped
-    {
-      public:
-        mmapped(const std::filesystem::path& filename)
-        {
-            if (std::filesystem::exists(filename)) {
-                mmapped_len_ = std::filesystem::file_size(filename);
-                fd_ = ::open(filename.c_str(), O_RDONLY);
-                if (fd_ >= 0) {
-                    mmapped_ = reinterpret_cast<char*>(mmap(nullptr, mmapped_len_, PROT_READ, MAP_FILE | MAP_PRIVATE, fd_, 0));
-                    if (mmapped_ == MAP_FAILED)
-                        throw cannot_read{fmt::format("{}: {}", filename.native(), strerror(errno))};
-                }
-                else
-                    throw not_opened{fmt::format("{}: {}", filename.native(), strerror(errno))};
-            }
-            else
-                throw not_found{std::string{filename}};
-        }
-        mmapped(const mmapped&) = delete;
-        mmapped operator=(const mmapped&) = delete;
-
-        ~mmapped()
-        {
-            if (fd_ > 2) {
-                if (mmapped_)
-                    munmap(mmapped_, mmapped_len_);
-                close(fd_);
-            }
-        }
-
-        operator std::string_view() { return {mmapped_, mmapped_len_}; }
-
-      private:
-        int fd_{-1};
-        char* mmapped_{nullptr};
-        size_t mmapped_len_{0};
-    };
-
     inline std::string read_via_mmap(const std::filesystem::path& filename, size_t padding)
     {
         mmapped mapped{filename};
@@ -103,6 +104,56 @@ namespace ae::file::detail
 
 // ----------------------------------------------------------------------
 
+ae::file::mmapped::mmapped(const std::filesystem::path& filename)
+{
+    if (std::filesystem::exists(filename)) {
+        mmapped_len_ = std::filesystem::file_size(filename);
+        fd_ = ::open(filename.c_str(), O_RDONLY);
+        if (fd_ >= 0) {
+            mmapped_ = reinterpret_cast<char*>(mmap(nullptr, mmapped_len_, PROT_READ, MAP_FILE | MAP_PRIVATE, fd_, 0));
+            if (mmapped_ == MAP_FAILED)
+                throw cannot_read{fmt::format("{}: {}", filename.native(), strerror(errno))};
+        }
+        else
+            throw not_opened{fmt::format("{}: {}", filename.native(), strerror(errno))};
+    }
+    else
+        throw not_found{std::string{filename}};
+
+} // ae::file::mmapped::mmapped
+
+// ----------------------------------------------------------------------
+
+ae::file::mmapped::~mmapped()
+{
+    if (fd_ > 2) {
+        if (mmapped_)
+            munmap(mmapped_, mmapped_len_);
+        close(fd_);
+    }
+
+} // ae::file::mmapped::~mmapped
+
+// ----------------------------------------------------------------------
+
+const ae::file::xz_settings_t& ae::file::xz_settings()
+{
+    return detail::xz_settings_;
+
+} // ae::file::xz_settings
+
+// ----------------------------------------------------------------------
+
+void ae::file::xz_settings(const xz_settings_t& settings)
+{
+    if (settings.preset > 9)
+        throw std::invalid_argument{fmt::format("invalid xz preset {}, 0-9 expected", settings.preset)};
+    detail::xz_settings_ = settings;
+
+} // ae::file::xz_settings
+
+// ----------------------------------------------------------------------
+
 std::string ae::file::read(const std::filesystem::path& filename, size_t padding)
 {
     if (filename == "-")
@@ -114,6 +165,30 @@ std::string ae::file::read(const std::filesystem::path& filename, size_t padding
 
 // ----------------------------------------------------------------------
 
+ae::file::read_view_t::read_view_t(const std::filesystem::path& filename, size_t padding)
+{
+    if (filename == "-")
+        copy_ = detail::read_stdin(padding);
+    else if (std::filesystem::is_regular_file(filename) && std::filesystem::file_size(filename) == 0)
+        copy_.reserve(padding); // empty file cannot be mapped
+    else {
+        auto mapped = std::make_unique<mmapped>(filename);
+        const std::string_view data{*mapped};
+        const auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        // bytes after the end of file up to the page boundary are mapped (zero filled), next page is not
+        if (const auto tail = data.size() % page_size; !data.empty() && tail != 0 && (page_size - tail) >= padding) {
+            if (!detail::compressor_factory(data, {}, force_compression::no, padding)) {
+                mapped_ = std::move(mapped);
+                return;
+            }
+        }
+        copy_ = decompress_if_necessary(data, padding);
+    }
+
+} // ae::file::read_view_t::read_view_t
+
+// ----------------------------------------------------------------------
+
 std::string ae::file::decompress_if_necessary(std::string_view source, size_t padding)
 {
     if (auto compressor = detail::compressor_factory(source, {}, force_compression::no, padding); compressor) {
@@ -178,28 +253,9 @@ void ae::file::backup(const std::filesystem::path& to_backup, backup_move bm)
 
 void ae::file::write(const std::filesystem::path& filename, std::string_view data, force_compression aForceCompression, backup_file a_backup_file)
 {
-    using namespace std::string_view_literals;
-    int f = -1;
-    if (filename == "-") {
-        f = 1;
-    }
-    else if (filename == "=") {
-        f = 2;
-    }
-    else if (filename == "/") {
-        f = open("/dev/null", O_WRONLY | O_TRUNC | O_CREAT, 0644);
-        if (f < 0)
-            throw std::runtime_error(fmt::format("Cannot open /dev/null: {}", strerror(errno)));
-    }
-    else {
-        if (a_backup_file == backup_file::yes && filename.native().substr(0, 4) != "/dev") // allow writing to /dev/ without making backup attempt
-            backup(filename);
-        f = open(filename.c_str(), O_WRONLY | O_TRUNC | O_CREAT, 0644);
-        if (f < 0)
-            throw std::runtime_error(fmt::format("Cannot open {}: {}", filename, strerror(errno)));
-    }
+    const int f = detail::open_for_writing(filename, a_backup_file);
     try {
-        if (aForceCompression == force_compression::yes || extension_of(filename, {".br", ".tjb", "jbr", ".xz", ".gz", ".tjz", ".jxz"})) {
+        if (aForceCompression == force_compression::yes || detail::compressed_extension(filename)) {
             std::string compressed_data;
             if (auto compressor = detail::compressor_factory({}, filename, aForceCompression, 0); compressor) {
                 compressed_data = compressor->compress(data);
@@ -225,6 +281,108 @@ void ae::file::write(const std::filesystem::path& filename, std::string_view dat
 
 // ----------------------------------------------------------------------
 
+ae::file::output_sink_t::output_sink_t(const std::filesystem::path& filename, force_compression aForceCompression, backup_file aBackupFile)
+    : filename_{filename}
+{
+    if (detail::written_directly(filename))
+        fd_ = detail::open_for_writing(filename, backup_file::no);
+    else {
+        if (aBackupFile == backup_file::yes)
+            backup(filename);
+        temp_ = detail::temp_name(filename);
+        fd_ = open(temp_.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+        if (fd_ < 0)
+            throw std::runtime_error(fmt::format("Cannot open {}: {}", temp_, strerror(errno)));
+    }
+
+    try {
+        if (aForceCompression == force_compression::yes || detail::compressed_extension(filename)) {
+            if (compressor_ = detail::compressor_factory({}, filename, aForceCompression, 0); compressor_)
+                compressor_->compress_begin([this](std::string_view compressed) { write_to_file(compressed); });
+        }
+    }
+    catch (std::exception&) {
+        remove_temp();
+        throw;
+    }
+
+} // ae::file::output_sink_t::output_sink_t
+
+// ----------------------------------------------------------------------
+
+ae::file::output_sink_t::~output_sink_t()
+{
+    remove_temp();
+
+} // ae::file::output_sink_t::~output_sink_t
+
+// ----------------------------------------------------------------------
+
+void ae::file::output_sink_t::append(std::string_view chunk)
+{
+    if (compressor_)
+        compressor_->compress_chunk(chunk);
+    else
+        write_to_file(chunk);
+
+} // ae::file::output_sink_t::append
+
+// ----------------------------------------------------------------------
+
+void ae::file::output_sink_t::finish()
+{
+    if (compressor_) {
+        compressor_->compress_end();
+        compressor_.reset();
+    }
+    if (fd_ > 2 && ::close(fd_) < 0) {
+        fd_ = -1;
+        throw std::runtime_error(fmt::format("Cannot write {}: {}", filename_, strerror(errno)));
+    }
+    fd_ = -1;
+    if (!temp_.empty()) {
+        std::filesystem::rename(temp_, filename_);
+        temp_.clear();
+    }
+
+} // ae::file::output_sink_t::finish
+
+// ----------------------------------------------------------------------
+
+void ae::file::output_sink_t::write_to_file(std::string_view data)
+{
+    if (fd_ < 0)
+        throw std::runtime_error(fmt::format("Cannot write {}: already closed", filename_));
+    if (::write(fd_, data.data(), data.size()) < 0)
+        throw std::runtime_error(fmt::format("Cannot write {}: {}", filename_, strerror(errno)));
+
+} // ae::file::output_sink_t::write_to_file
+
+// ----------------------------------------------------------------------
+
+void ae::file::output_sink_t::close()
+{
+    if (fd_ > 2)
+        ::close(fd_);
+    fd_ = -1;
+
+} // ae::file::output_sink_t::close
+
+// ----------------------------------------------------------------------
+
+void ae::file::output_sink_t::remove_temp()
+{
+    close();
+    if (!temp_.empty()) {
+        std::error_code ec;
+        std::filesystem::remove(temp_, ec);
+        temp_.clear();
+    }
+
+} // ae::file::output_sink_t::remove_temp
+
+// ----------------------------------------------------------------------
+
 ae::file::temp::temp(std::string_view prefix, std::string_view suffix, bool autoremove)
     : name_{fmt::format("{}{}", make_template(prefix), suffix)}, autoremove_{autoremove}, fd_(mkstemps(const_cast<char*>(name_.c_str()), static_cast<int>(suffix.size())))
 {
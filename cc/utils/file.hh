@@ -3,6 +3,7 @@
 #include <stdexcept>
 #include <string_view>
 #include <memory>
+#include <cstdint>
 
 #include "ext/filesystem.hh"
 #include "ext/compressor.hh"
@@ -32,10 +33,93 @@ namespace ae::file
     class not_found : public file_error { public: not_found(std::string_view aFilename) : file_error(fmt::format("not found: {}", aFilename)) {} };
 
     std::string read(const std::filesystem::path& filename, size_t padding = 0);
+
+    // read-only memory mapped file
+    class mmapped
+    {
+      public:
+        mmapped(const std::filesystem::path& filename);
+        mmapped(const mmapped&) = delete;
+        mmapped& operator=(const mmapped&) = delete;
+        ~mmapped();
+
+        operator std::string_view() const { return {mmapped_, mmapped_len_}; }
+
+      private:
+        int fd_{-1};
+        char* mmapped_{nullptr};
+        size_t mmapped_len_{0};
+    };
+
+    // Contents of a file, like read(), but an uncompressed file is memory
+    // mapped instead of copied. At least padding bytes after the end of
+    // view() are readable (simdjson): the file is mapped only if the
+    // padding fits into the rest of its last page, otherwise (and for
+    // compressed files, empty files and stdin) the data is read into a
+    // string with that padding.
+    class read_view_t
+    {
+      public:
+        read_view_t(const std::filesystem::path& filename, size_t padding = 0);
+
+        std::string_view view() const { return mapped_ ? static_cast<std::string_view>(*mapped_) : std::string_view{copy_}; }
+        operator std::string_view() const { return view(); }
+        const char* data() const { return view().data(); }
+        size_t size() const { return view().size(); }
+        bool empty() const { return view().empty(); }
+        bool mapped() const { return static_cast<bool>(mapped_); }
+
+      private:
+        std::unique_ptr<mmapped> mapped_{};
+        std::string copy_{};
+    };
+
     // inline read_access read_from_file_descriptor(int fd, size_t chunk_size = 1024) { return read_access(fd, chunk_size); }
     // inline read_access read_stdin() { return read_from_file_descriptor(0); }
     void write(const std::filesystem::path& filename, std::string_view data, force_compression aForceCompression = force_compression::no, backup_file aBackupFile = backup_file::yes);
 
+    // Writes a document exported in chunks (see chunk_sink_t), compressing
+    // it the same way as write(). Memory use is bounded by the chunk and
+    // compressor buffer sizes rather than by the document size. Output
+    // goes to a temporary file in the same directory which replaces
+    // filename in finish(), i.e. failed export leaves the previous file
+    // intact (stdout, stderr and devices are written directly).
+    class output_sink_t
+    {
+      public:
+        output_sink_t(const std::filesystem::path& filename, force_compression aForceCompression = force_compression::no, backup_file aBackupFile = backup_file::yes);
+        output_sink_t(const output_sink_t&) = delete;
+        output_sink_t& operator=(const output_sink_t&) = delete;
+        ~output_sink_t(); // removes temporary file unless finish() was called
+
+        void append(std::string_view chunk);
+        void finish(); // completes compressed stream, closes file and renames it to filename
+        chunk_sink_t sink() { return [this](std::string_view chunk) { append(chunk); }; }
+
+      private:
+        std::filesystem::path filename_;
+        std::filesystem::path temp_{}; // empty if written directly or after finish()
+        int fd_{-1};
+        std::unique_ptr<Compressor> compressor_{};
+
+        void write_to_file(std::string_view data);
+        void close();
+        void remove_temp();
+    };
+
+    // xz compression used by write() (process wide), preset: 0 (fast) - 9
+    // (best), extreme: slower, slightly better ratio, threads: 0 - number
+    // of cores
+    struct xz_settings_t
+    {
+        uint32_t preset{9};
+        bool extreme{true};
+        uint32_t threads{0};
+    };
+
+    const xz_settings_t& xz_settings();
+    void xz_settings(const xz_settings_t& settings);
+
     void backup(const std::filesystem::path& to_backup, const std::filesystem::path& backup_dir, backup_move bm = backup_move::no);
     void backup(const std::filesystem::path& to_backup, backup_move bm = backup_move::no);
 